@@ -8,6 +8,40 @@ from termcolor import colored
 from time import localtime, strftime, gmtime
 from datetime import datetime, timezone
 
+def textFrame(fields):
+    # Each field is preceded by CR LF, the checksum byte completes the sum of all bytes to zero (modulo 256)
+    frame=b''
+    for label, value in fields:
+        frame+=b'\r\n' + label.encode() + b'\t' + str(value).encode()
+    frame+=b'\r\nChecksum\t'
+    return frame + bytes([(256 - (sum(frame) % 256)) % 256])
+
+def hexFrame(command, data):
+    # ':' command nibble, data bytes and checksum in hex; command + data + checksum is 0x55 (modulo 256)
+    checksum=(0x55 - command - sum(data)) & 0xFF
+    return (":{0:X}".format(command) + "".join("{0:02X}".format(b) for b in data) + "{0:02X}\n".format(checksum)).encode()
+
+def hexAnswer(line, registers):
+    # Answer get (7) and set (8) of a register, the values are stored in registers
+    line=line.strip()
+    if ((len(line) < 2) or (line[0] != ':')):
+        return None
+    try:
+        command=int(line[1], 16)
+        data=bytes.fromhex(line[2:])
+    except ValueError:
+        return hexFrame(0x4, [0xAA, 0xAA])  # frame error
+    if ((command + sum(data)) & 0xFF) != 0x55:
+        return hexFrame(0x4, [0xAA, 0xAA])  # frame error
+    if ((command not in (0x7, 0x8)) or (len(data) < 4)):
+        return hexFrame(0x3, [0x00, 0x00])  # unknown command
+    reg=data[0] | (data[1] << 8)
+    if (reg not in registers):
+        return hexFrame(command, list(data[0:2]) + [0x01])  # unknown id
+    if (command == 0x8):
+        registers[reg]=list(data[3:-1])
+    return hexFrame(command, list(data[0:2]) + [0x00] + registers[reg])
+
 parser = argparse.ArgumentParser()
 parser.add_argument('-d', '--device', help='ttyUSB device. By default, /dev/ttyUSB0 is used.')
 args = parser.parse_args()
@@ -17,7 +51,7 @@ if (args.device):
 else:
     serialDevice="/dev/ttyUSB0"
 
-with serial.Serial(serialDevice, 19200, timeout=1)  as ser:
+with serial.Serial(serialDevice, 19200, timeout=0.1)  as ser:
     print(ser.name)         # check which port was really used
 
     lastUpdate=0
@@ -27,6 +61,8 @@ with serial.Serial(serialDevice, 19200, timeout=1)  as ser:
     battery_current = 1
     panel_volt = 13000
     panel_power = 2
+    # registers of the HEX protocol, value as little endian bytes
+    registers={ 0xEDAB: [ 0x01 ] } # load output control: auto
 
     # Main Loop
     while (True):
@@ -36,18 +72,22 @@ with serial.Serial(serialDevice, 19200, timeout=1)  as ser:
 
         if ((s is not None) and (len(s) > 0)):
             print(colored(strftime("%Y-%m-%d %H:%M:%S", gmtime()) + " " + str(s.decode('utf-8', errors='ignore')).rstrip(), "green"))
+            answer=hexAnswer(s.decode('utf-8', errors='ignore'), registers)
+            if (answer is not None):
+                ser.write(answer)
+                print(colored(answer.decode().rstrip(), "yellow"))
         
         if (updateSerial):
             lastUpdate=int(time.time())
             # Send the status string
             
-            outStr="FW\t159\nSER#\tHQ2202K3VD9\nV\t{0:d}\nI\t{1:d}\nVPV\t{2:d}\nPPV\t{3:d}\nChecksum	f\r\n".format(battery_volt, battery_current, panel_volt, panel_power)
+            out=textFrame([("FW", 159), ("SER#", "HQ2202K3VD9"), ("V", battery_volt), ("I", battery_current), ("VPV", panel_volt), ("PPV", panel_power)])
             # Other values
-            # CS\t{4:d}\nMPPT\t{5:d}\nERR\t{6:d}\nLOAD\t{7}\nIL\t{8:d}\nH19\t{9:d}\nH20\t{10:d}\nH21\t{11:d}\nH22\t{12:d}\nH23\t{13:d}\nHSDS\t{14:d}\n
+            # CS, MPPT, ERR, LOAD, IL, H19, H20, H21, H22, H23, HSDS
 
-            # write a string
-            ser.write(outStr.encode(encoding='UTF-8'))
-            print(colored(outStr.rstrip(), "white"))
+            # write the frame
+            ser.write(out)
+            print(colored(out.decode('utf-8', errors='ignore').strip(), "white"))
             time.sleep(0.2)
             panel_volt = panel_volt + 1
             panel_power = panel_power + 1
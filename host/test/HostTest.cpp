@@ -0,0 +1,42 @@
+/**
+ * @file HostTest.cpp
+ * @brief Checks and stand-ins of the host tests
+ * @version 0.1
+ *
+ */
+
+#include "HostTest.h"
+#include "MqttLog.h"
+#include <fstream>
+#include <sstream>
+
+long mLogLevel = MQTT_LEVEL_DEBUG;
+std::vector<std::string> hostLog;
+int hostFailures = 0;
+
+/* Replaces the MQTT logger: the messages are kept for the checks */
+bool log(int level, String message, int statusCode)
+{
+    if (logEnabled(level)) {
+        hostLog.push_back(message.c_str());
+    }
+    return logEnabled(level);
+}
+
+std::string hostReadFile(const char *name)
+{
+    std::ifstream file(std::string(HOST_DATA_DIR "/") + name, std::ios::binary);
+    std::stringstream content;
+    if (!file) {
+        printf("%s not found in %s\n", name, HOST_DATA_DIR);
+        hostFailures++;
+    }
+    content << file.rdbuf();
+    return content.str();
+}
+
+int hostResult(const char *name)
+{
+    printf("%s: %s (%d failed checks)\n", name, (hostFailures == 0) ? "passed" : "FAILED", hostFailures);
+    return (hostFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file HostTest.h
+ * @brief Checks and stand-ins of the host tests
+ * @version 0.1
+ *
+ * Each test is a small program: it returns the amount of failed checks (0 means passed).
+ */
+
+#ifndef HOST_TEST
+#define HOST_TEST
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+extern std::vector<std::string> hostLog;     /**< all messages, logged via log() */
+extern int hostFailures;
+
+#define CHECK(condition)                                                                \
+    do {                                                                                \
+        if (!(condition)) {                                                             \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition);        \
+            hostFailures++;                                                             \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_EQUAL(expected, actual)                                                   \
+    do {                                                                                \
+        long long e_ = (long long) (expected);                                          \
+        long long a_ = (long long) (actual);                                            \
+        if (e_ != a_) {                                                                 \
+            printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, a_, e_); \
+            hostFailures++;                                                             \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_TEXT(expected, actual)                                                    \
+    do {                                                                                \
+        std::string e_ = (expected);                                                    \
+        std::string a_ = (actual);                                                      \
+        if (e_ != a_) {                                                                 \
+            printf("%s:%d: %s is\n  \"%s\", expected\n  \"%s\"\n", __FILE__, __LINE__, #actual, a_.c_str(), e_.c_str()); \
+            hostFailures++;                                                             \
+        }                                                                               \
+    } while (0)
+
+/** Received bytes of a UART or a capture; written bytes are collected */
+class HostStream : public Stream
+{
+public:
+    std::string input;
+    size_t position = 0;
+    std::string output;
+
+    int available() override {
+        return input.size() - position;
+    }
+    int read() override {
+        return (position < input.size()) ? (uint8_t) input[position++] : -1;
+    }
+    int peek() override {
+        return (position < input.size()) ? (uint8_t) input[position] : -1;
+    }
+    size_t write(uint8_t c) override {
+        output += (char) c;
+        return 1;
+    }
+    using Print::write;
+};
+
+/**
+ * @brief Counter of the benchmarks: CPU cycles on x86, otherwise nanoseconds
+ * The host CPU has a FPU and caches, the values only compare two implementations on the same machine.
+ */
+inline uint64_t hostCycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/** Content of a file in the host folder, e.g. a recorded capture */
+std::string hostReadFile(const char *name);
+
+int hostResult(const char *name);
+
+#endif /* End of HOST_TEST */
@@ -0,0 +1,72 @@
+/**
+ * @file bench_altitude.cpp
+ * @brief Altitude table: error against the formula of the Adafruit libraries; cycles compared with powf()
+ * @version 0.1
+ *
+ */
+
+#include <cmath>
+#include "HostTest.h"
+#include "Altitude.h"
+
+#define ROUNDS          100000
+
+/** readAltitude() of the Adafruit libraries in cm */
+static double formula(int32_t pressure)
+{
+    return 4433000.0 * (1.0 - pow(pressure / (SEALEVELPRESSURE_HPA * 100), 0.1903));
+}
+
+static void testError()
+{
+    double worst = 0;
+
+    /* each Pa of the table */
+    for (int32_t pressure = ALTITUDE_PRESSURE_MIN; pressure <= ALTITUDE_PRESSURE_MAX; pressure++) {
+        double error = fabs(altitudeFromPressure(pressure) - formula(pressure));
+        if (error > worst) {
+            worst = error;
+        }
+    }
+    printf("Largest error of the table: %.1f cm\n", worst);
+    CHECK(worst < 100);
+    /* outside of the table the last entry is used */
+    CHECK_EQUAL(altitudeFromPressure(ALTITUDE_PRESSURE_MIN), altitudeFromPressure(0));
+    CHECK_EQUAL(altitudeFromPressure(ALTITUDE_PRESSURE_MAX), altitudeFromPressure(200000));
+}
+
+static void benchmark()
+{
+    int32_t pressures[256];
+    volatile int32_t sink = 0;
+    uint64_t start;
+    uint64_t table;
+    uint64_t power;
+
+    for (int i = 0; i < 256; i++) {
+        pressures[i] = 95000 + (rand() % 10000);
+    }
+
+    start = hostCycles();
+    for (int round = 0; round < ROUNDS; round++) {
+        sink = sink + altitudeFromPressure(pressures[round & 0xFF]);
+    }
+    table = hostCycles() - start;
+
+    start = hostCycles();
+    for (int round = 0; round < ROUNDS; round++) {
+        sink = sink + lroundf(4433000.0f * (1.0f - powf(pressures[round & 0xFF] / 101325.0f, 0.1903f)));
+    }
+    power = hostCycles() - start;
+    CHECK(sink != 0);
+
+    printf("Altitude: table %llu cycles, powf() %llu cycles\n",
+           (unsigned long long) (table / ROUNDS), (unsigned long long) (power / ROUNDS));
+}
+
+int main()
+{
+    testError();
+    benchmark();
+    return hostResult("bench_altitude");
+}
@@ -0,0 +1,132 @@
+/**
+ * @file bench_format.cpp
+ * @brief Format: output compared with snprintf() for random values; cycles of both
+ * @version 0.1
+ *
+ * The firmware has 32 bit long, therefore only values of int32_t are checked.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include "HostTest.h"
+#include "Format.h"
+
+#define VALUES          200000      /**< random values, compared with snprintf() */
+#define ROUNDS          100000
+
+static const long kPowers[FORMAT_DECIMALS_MAX + 1] = { 1L, 10L, 100L, 1000L, 10000L, 100000L, 1000000L };
+
+/** Random value of the whole range, small values are more frequent */
+static int32_t randomValue()
+{
+    int32_t value = (int32_t) (((uint32_t) rand() << 16) ^ (uint32_t) rand());
+    return value >> (rand() % 32);
+}
+
+static void testLimits()
+{
+    char buffer[FORMAT_NUMBER_MAX];
+
+    CHECK_TEXT("0", formatNumber(buffer, 0));
+    CHECK_TEXT("0.00", formatNumber(buffer, 0, 2));
+    CHECK_TEXT("-0.05", formatNumber(buffer, -5, 2));
+    CHECK_TEXT("21.53", formatNumber(buffer, 2153, 2));
+    CHECK_TEXT("-2147483648", formatNumber(buffer, -2147483647L - 1));
+    CHECK_TEXT("-2147.483648", formatNumber(buffer, -2147483647L - 1, 6));
+    CHECK_TEXT("4294967295", formatUnsigned(buffer, 4294967295UL));
+    CHECK_TEXT("ffffffff", formatUnsigned(buffer, 4294967295UL, 16));
+    CHECK_TEXT("37777777777", formatUnsigned(buffer, 4294967295UL, 8));
+    CHECK_TEXT("101", formatUnsigned(buffer, 5, 2));
+    CHECK_TEXT("255", formatUnsigned(buffer, 255, 1));
+    CHECK_TEXT("1013.3", formatScaled(buffer, 101325, 2, 1));
+    CHECK_TEXT("1013", formatScaled(buffer, 101349, 2, 0));
+    CHECK_TEXT("-1014", formatScaled(buffer, -101350, 2, 0));
+    CHECK_TEXT("21.500", formatScaled(buffer, 215, 1, 3));
+    /* out of range: no zeros are appended */
+    CHECK_TEXT("2147483.647", formatScaled(buffer, 2147483647L, 3, 6));
+}
+
+/** Each result must be the same as the one of snprintf() */
+static void testRandom()
+{
+    char buffer[FORMAT_NUMBER_MAX];
+    char expected[32];
+    int differences = 0;
+
+    srand(1);
+    for (int i = 0; i < VALUES; i++) {
+        int32_t value = randomValue();
+        uint8_t decimals = rand() % (FORMAT_DECIMALS_MAX + 1);
+        uint8_t scale = rand() % (FORMAT_DECIMALS_MAX + 1);
+
+        /* the quotient of the double is the nearest to the exact one, printf() prints the decimals exactly */
+        snprintf(expected, sizeof(expected), "%.*f", decimals, (double) value / kPowers[decimals]);
+        if (strcmp(expected, formatNumber(buffer, value, decimals)) != 0) {
+            differences++;
+        }
+        snprintf(expected, sizeof(expected), "%lu", (unsigned long) (uint32_t) value);
+        if (strcmp(expected, formatUnsigned(buffer, (uint32_t) value)) != 0) {
+            differences++;
+        }
+        snprintf(expected, sizeof(expected), "%lx", (unsigned long) (uint32_t) value);
+        if (strcmp(expected, formatUnsigned(buffer, (uint32_t) value, 16)) != 0) {
+            differences++;
+        }
+        if (decimals < scale) {
+            /* rounding half away from zero, like lround() */
+            long rounded = lround((double) value / kPowers[scale - decimals]);
+            snprintf(expected, sizeof(expected), "%.*f", decimals, (double) rounded / kPowers[decimals]);
+        } else if (((int64_t) value * kPowers[decimals - scale]) == (int32_t) (value * kPowers[decimals - scale])) {
+            snprintf(expected, sizeof(expected), "%.*f", decimals, (double) value / kPowers[scale]);
+        } else {
+            snprintf(expected, sizeof(expected), "%.*f", scale, (double) value / kPowers[scale]);
+        }
+        if (strcmp(expected, formatScaled(buffer, value, scale, decimals)) != 0) {
+            if (differences < 10) {
+                printf("formatScaled(%ld, %u, %u) is %s, expected %s\n", (long) value, scale, decimals, buffer, expected);
+            }
+            differences++;
+        }
+    }
+    CHECK_EQUAL(0, differences);
+}
+
+static void benchmark()
+{
+    char buffer[FORMAT_NUMBER_MAX];
+    char text[32];
+    int32_t values[256];
+    volatile size_t sink = 0;
+    uint64_t start;
+    uint64_t format;
+    uint64_t print;
+
+    for (int i = 0; i < 256; i++) {
+        values[i] = (rand() % 200000) - 100000;     /* e.g. temperatures in 0.01 °C */
+    }
+
+    start = hostCycles();
+    for (int round = 0; round < ROUNDS; round++) {
+        sink = sink + formatNumber(buffer, values[round & 0xFF], 2)[0];
+    }
+    format = hostCycles() - start;
+
+    start = hostCycles();
+    for (int round = 0; round < ROUNDS; round++) {
+        snprintf(text, sizeof(text), "%.2f", values[round & 0xFF] / 100.0f);
+        sink = sink + text[0];
+    }
+    print = hostCycles() - start;
+    CHECK(sink > 0);
+
+    printf("Value with 2 decimals: formatNumber %llu cycles, snprintf(\"%%.2f\") of the float %llu cycles\n",
+           (unsigned long long) (format / ROUNDS), (unsigned long long) (print / ROUNDS));
+}
+
+int main()
+{
+    testLimits();
+    testRandom();
+    benchmark();
+    return hostResult("bench_format");
+}
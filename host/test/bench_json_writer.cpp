@@ -0,0 +1,183 @@
+/**
+ * @file bench_json_writer.cpp
+ * @brief JsonWriter: escaping, numbers, overflow; heap allocations and cycles of the MPPT document
+ * @version 0.1
+ *
+ */
+
+#include <cstdlib>
+#include <new>
+#include "HostTest.h"
+#include "JsonWriter.h"
+#include "VictronTexts.h"
+#include "victron.h"
+
+#define ROUNDS          10000
+
+/** Heap allocations of the whole test, the host String is a std::string */
+static size_t mAllocations = 0;
+
+void *operator new(size_t size)
+{
+    mAllocations++;
+    void *memory = malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+static void testDocument()
+{
+    char buffer[128];
+    JsonWriter json(buffer, sizeof(buffer));
+
+    json.beginObject();
+    json.add("a", -12L);
+    json.addFixed("b", -5L, 2);
+    json.addFixed("c", 12345L, 2);
+    json.beginArray("d");
+    json.add(NULL, 1L);
+    json.add(NULL, "x");
+    json.endArray();
+    json.add("e", "q\"b\\s\n\x01");
+    json.addP("f", PSTR("flash"));
+    json.beginObject("g");
+    json.endObject();
+    json.endObject();
+    CHECK(!json.overflow());
+    CHECK_TEXT("{\"a\":-12,\"b\":-0.05,\"c\":123.45,\"d\":[1,\"x\"],\"e\":\"q\\\"b\\\\s\\n\\u0001\",\"f\":\"flash\",\"g\":{}}", buffer);
+    CHECK_EQUAL(strlen(buffer), json.length());
+}
+
+static void testOverflow()
+{
+    char buffer[12];
+    JsonWriter json(buffer, sizeof(buffer));
+    size_t mark;
+
+    json.beginObject();
+    json.add("a", 1L);
+    mark = json.mark();
+    json.add("long", "does not fit");
+    CHECK(json.overflow());
+    CHECK_EQUAL(0, json.length());
+    CHECK(strlen(buffer) < sizeof(buffer));
+    /* remove the element again and close the document */
+    json.rewind(mark);
+    json.endObject();
+    CHECK(!json.overflow());
+    CHECK_TEXT("{\"a\":1}", buffer);
+}
+
+/** The former VictronComponent::toJson(): String concatenation, with the same values */
+static String stringDocument(const victron::VictronData &data)
+{
+    String buffer;
+    buffer += "{ ";
+    buffer += "\"mode\": \"newdata\",\n";
+    buffer += "\"load\":" + String(data.load_state_binary_sensor_) + ",\n";
+    buffer += "\"MaxPower\":{\n";
+    buffer += "\"yesterday\":" + String(data.max_power_yesterday_sensor_) + ",\n";
+    buffer += "\"today\":" + String(data.max_power_today_sensor_) + "\n";
+    buffer += "},\n";
+    buffer += "\"Yield\":{\n";
+    buffer += "\"Total\":" + String(data.yield_total_sensor_) + ",\n";
+    buffer += "\"Yesterday\":" + String(data.yield_yesterday_sensor_) + ",\n";
+    buffer += "\"Today\":" + String(data.yield_today_sensor_) + "\n";
+    buffer += "},\n";
+    buffer += "\"Panel\":{\n";
+    buffer += "\"Voltage\":" + String(data.panel_voltage_sensor_) + ",\n";
+    buffer += "\"Power\":" + String(data.panel_power_sensor_) + "\n";
+    buffer += "},\n";
+    buffer += "\"Bat\":{\n";
+    buffer += "\"Voltage\":" + String(data.battery_voltage_sensor_) + ",\n";
+    buffer += "\"Current\":" + String(data.battery_current_sensor_) + "\n";
+    buffer += "},\n";
+    buffer += "\"LoadCurrent\":" + String(data.load_current_sensor_) + ",\n";
+    buffer += "\"DayNumber\":" + String(data.day_number_sensor_) + ",\n";
+    buffer += "\"ChargingModeID\":" + String(data.charging_mode_id_sensor_) + ",\n";
+    buffer += "\"ErrorCode\":" + String(data.error_code_sensor_) + ",\n";
+    buffer += "\"TrackingModeID\":" + String(data.tracking_mode_id_sensor_) + ",\n";
+    buffer += "\"ErrorText\": \"" + String(error_code_text(data.error_code_sensor_)) + "\",\n";
+    buffer += "\"TrackingMode\": \"" + String(tracking_mode_text(data.tracking_mode_id_sensor_)) + "\",\n";
+    buffer += "\"ChargingMode\": \"" + String(charging_mode_text(data.charging_mode_id_sensor_)) + "\",\n";
+    buffer += "\"DeviceType\": \"" + String(device_type_text(data.device_type_text_sensor_)) + "\",\n";
+    buffer += "}";
+    return buffer;
+}
+
+static void benchmark()
+{
+    HostStream uart;
+    victron::VictronComponent charger(uart);
+    char buffer[VICTRON_JSON_MAX];
+    volatile size_t sink = 0;
+    size_t allocations;
+    uint64_t start;
+    uint64_t writer;
+    uint64_t concatenation;
+
+    uart.input = hostReadFile("VictronDummyData.txt");
+    while (uart.available() > 0) {
+        charger.loop();
+        hostMillis += 10;
+    }
+
+    allocations = mAllocations;
+    start = hostCycles();
+    for (int round = 0; round < ROUNDS; round++) {
+        sink = sink + charger.toJson(buffer, sizeof(buffer));
+    }
+    writer = hostCycles() - start;
+    CHECK_EQUAL(0, mAllocations - allocations);
+    CHECK(sink > 0);
+
+    /* the values of host/VictronDummyData.txt */
+    victron::VictronData data;
+    data.load_state_binary_sensor_ = true;
+    data.max_power_yesterday_sensor_ = 12;
+    data.max_power_today_sensor_ = 10;
+    data.yield_total_sensor_ = 80;
+    data.yield_yesterday_sensor_ = 110;
+    data.yield_today_sensor_ = 90;
+    data.panel_voltage_sensor_ = 2;
+    data.panel_power_sensor_ = 3;
+    data.battery_voltage_sensor_ = 26310;
+    data.battery_current_sensor_ = 1;
+    data.load_current_sensor_ = 7;
+    data.day_number_sensor_ = 13;
+    data.charging_mode_id_sensor_ = 4;
+    data.error_code_sensor_ = 6;
+    data.tracking_mode_id_sensor_ = 5;
+    data.device_type_text_sensor_ = 0xA042;
+
+    allocations = mAllocations;
+    start = hostCycles();
+    for (int round = 0; round < ROUNDS; round++) {
+        sink = sink + stringDocument(data).length();
+    }
+    concatenation = hostCycles() - start;
+
+    printf("MPPT document: JsonWriter %llu cycles, 0 allocations; String concatenation %llu cycles, %llu allocations\n",
+           (unsigned long long) (writer / ROUNDS), (unsigned long long) (concatenation / ROUNDS),
+           (unsigned long long) ((mAllocations - allocations) / ROUNDS));
+}
+
+int main()
+{
+    testDocument();
+    testOverflow();
+    benchmark();
+    return hostResult("bench_json_writer");
+}
@@ -0,0 +1,95 @@
+/**
+ * @file bench_victron_labels.cpp
+ * @brief Label dispatch of the VE.Direct parser: hash table against the former comparison chain
+ * @version 0.1
+ *
+ */
+
+#include "HostTest.h"
+#include "victron.h"
+
+using namespace victron;
+
+/** Labels of one frame of a BlueSolar MPPT 75|10 (host/VictronDummyData.txt) */
+static const char *const kFrame[] = {
+    "SER#", "V", "I", "VPV", "PPV", "CS", "MPPT", "ERR", "LOAD", "IL",
+    "H19", "H20", "H21", "H22", "H23", "HSDS", "PID", "FW"
+};
+#define FRAME_LABELS    (sizeof(kFrame) / sizeof(kFrame[0]))
+#define ROUNDS          20000
+
+/** The former handle_value_(): one std::string comparison per known label, until one matches */
+static int chainDispatch(const std::string &label)
+{
+    static const char *const kChain[] = {
+        "V", "VPV", "PPV", "I", "IL", "LOAD", "Alarm", "H19", "H20", "H21",
+        "H22", "H23", "ERR", "CS", "FW", "PID", "HSDS", "MPPT"
+    };
+    for (size_t i = 0; i < (sizeof(kChain) / sizeof(kChain[0])); i++) {
+        if (label == kChain[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/** The label is hashed byte by byte while it is received, the table is searched once */
+static int tableDispatch(const char *label)
+{
+    VictronLabel entry;
+    uint32_t hash = label_hash("");
+    for (const char *c = label; *c; c++) {
+        hash = label_hash_step(hash, *c);
+    }
+    return find_label(hash, label, entry) ? entry.field : -1;
+}
+
+static void testLabels()
+{
+    VictronLabel entry;
+
+    CHECK(find_label(label_hash("V"), "V", entry) && (entry.field == FIELD_BATTERY_VOLTAGE) && (entry.parse == PARSE_INT));
+    CHECK(find_label(label_hash("H20"), "H20", entry) && (entry.field == FIELD_YIELD_TODAY) && (entry.parse == PARSE_YIELD));
+    CHECK(find_label(label_hash("PID"), "PID", entry) && (entry.field == FIELD_DEVICE_TYPE) && (entry.parse == PARSE_HEX));
+    CHECK(find_label(label_hash("LOAD"), "LOAD", entry) && (entry.parse == PARSE_ONOFF));
+    CHECK(find_label(label_hash("SER#"), "SER#", entry) && (entry.field == FIELD_SKIP));
+    CHECK(!find_label(label_hash("XYZ"), "XYZ", entry));
+    for (const char *label : kFrame) {
+        CHECK(find_label(label_hash(label), label, entry));
+    }
+}
+
+static void benchmark()
+{
+    std::vector<std::string> labels(kFrame, kFrame + FRAME_LABELS);
+    volatile int sink = 0;
+    uint64_t start;
+    uint64_t chain;
+    uint64_t table;
+
+    start = hostCycles();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (const std::string &label : labels) {
+            sink = sink + chainDispatch(label);
+        }
+    }
+    chain = hostCycles() - start;
+
+    start = hostCycles();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (const char *label : kFrame) {
+            sink = sink + tableDispatch(label);
+        }
+    }
+    table = hostCycles() - start;
+
+    printf("label dispatch per frame (%u labels): comparison chain %llu, hash table %llu cycles\n",
+           (unsigned int) FRAME_LABELS, (unsigned long long) (chain / ROUNDS), (unsigned long long) (table / ROUNDS));
+}
+
+int main()
+{
+    testLabels();
+    benchmark();
+    return hostResult("bench_victron_labels");
+}
@@ -0,0 +1,81 @@
+/**
+ * @file bench_victron_replay.cpp
+ * @brief Replay of host/VictronDummyData.txt: UART timing, maximum speed and the throughput of the parser
+ * @version 0.1
+ *
+ */
+
+#include "HostTest.h"
+#include "victron.h"
+#include "VictronReplay.h"
+
+#define REPEATS         1000
+
+/* With the timing of the UART: 10 bits per byte */
+static void testRealtime()
+{
+    HostStream capture;
+    victron::VictronReplay replay(capture, 19200);
+    victron::VictronComponent charger(replay);
+
+    capture.input = hostReadFile("VictronDummyData.txt");
+    CHECK_EQUAL(0, replay.getDuration());
+    CHECK_EQUAL(0, replay.available());
+    hostMillis += 100;
+    CHECK_EQUAL(192, replay.available());
+    CHECK_EQUAL(100, replay.getDuration());
+    while (capture.available() > 0) {
+        charger.loop();
+        hostMillis += 10;
+    }
+    CHECK_EQUAL(capture.input.size(), replay.getBytes());
+    CHECK_EQUAL(2, charger.getGoodFrames());
+    /* 298 bytes need 155 ms */
+    CHECK(replay.getDuration() >= 150);
+    CHECK(replay.getDuration() < 200);
+    /* the duration ends with the last byte of the capture */
+    const uint32_t duration = replay.getDuration();
+    hostMillis += 60000;
+    CHECK_EQUAL(duration, replay.getDuration());
+    /* requests to the charger are dropped */
+    CHECK_EQUAL(1, replay.write((uint8_t) ':'));
+}
+
+/* The parser is only limited by VICTRON_BYTES_PER_LOOP */
+static void benchmark()
+{
+    HostStream capture;
+    victron::VictronReplay replay(capture, VICTRON_REPLAY_MAXSPEED);
+    victron::VictronComponent charger(replay);
+    const std::string recorded = hostReadFile("VictronDummyData.txt");
+    uint32_t calls = 0;
+    uint64_t start;
+    uint64_t cycles;
+
+    for (int i = 0; i < REPEATS; i++) {
+        capture.input += recorded;
+    }
+    CHECK_EQUAL(capture.input.size(), replay.available());
+
+    start = hostCycles();
+    while (replay.available() > 0) {
+        charger.loop();
+        calls++;
+    }
+    cycles = hostCycles() - start;
+
+    CHECK_EQUAL(capture.input.size(), charger.getBytesReceived());
+    CHECK_EQUAL(2 * REPEATS, charger.getGoodFrames());
+    CHECK_EQUAL(0, charger.getBadFrames());
+    CHECK_EQUAL((capture.input.size() + VICTRON_BYTES_PER_LOOP - 1) / VICTRON_BYTES_PER_LOOP, calls);
+    printf("replay of %u bytes: %llu cycles per byte, %llu cycles per loop() call\n",
+           (unsigned int) capture.input.size(), (unsigned long long) (cycles / capture.input.size()),
+           (unsigned long long) (cycles / calls));
+}
+
+int main()
+{
+    testRealtime();
+    benchmark();
+    return hostResult("bench_victron_replay");
+}
@@ -0,0 +1,81 @@
+/**
+ * @file bench_victron_texts.cpp
+ * @brief Texts of the Victron codes: flash tables against the former switch statements
+ * @version 0.1
+ *
+ */
+
+#include <string>
+#include "HostTest.h"
+#include "VictronTexts.h"
+
+namespace former {
+#include "former/VictronTexts.h"
+}
+
+#define CODES           0x10000L    /**< all codes of the tables are below */
+#define ESP_ENTRY_SIZE  8           /**< code and pointer of one table entry on the ESP8266 */
+
+static size_t mTexts = 0;           /**< bytes of the texts with their terminating zero */
+static size_t mEntries = 0;
+
+/* Every code has the text of the former switch statement, including "Unknown" */
+template<typename Former, typename Table>
+static void compare(const char *name, Former former, Table table)
+{
+    int mismatches = 0;
+    for (long code = -1; code <= CODES; code++) {
+        std::string expected = former(code);
+        std::string actual = table(code);
+        if (expected != actual) {
+            if (mismatches++ == 0) {
+                printf("%s(0x%lx) is \"%s\", expected \"%s\"\n", name, code, actual.c_str(), expected.c_str());
+            }
+        } else if (expected != "Unknown") {
+            mTexts += expected.length() + 1;
+            mEntries++;
+        }
+    }
+    CHECK_EQUAL(0, mismatches);
+}
+
+/* The codes of a frame: the values of host/VictronDummyData.txt */
+static void benchmark()
+{
+    static const long kDevices[] = { 0xA042, 0xA053, 0xA060, 0xA442, 0x1234 };
+    volatile size_t sink = 0;
+    uint64_t start;
+    uint64_t table;
+    uint64_t switches;
+    const int rounds = 100000;
+
+    start = hostCycles();
+    for (int round = 0; round < rounds; round++) {
+        sink = sink + strlen(error_code_text(round % 120)) + strlen(charging_mode_text(round % 12)) +
+               strlen(tracking_mode_text(round % 3)) + strlen(device_type_text(kDevices[round % 5]));
+    }
+    table = hostCycles() - start;
+
+    start = hostCycles();
+    for (int round = 0; round < rounds; round++) {
+        sink = sink + former::error_code_text(round % 120).length() + former::charging_mode_text(round % 12).length() +
+               former::tracking_mode_text(round % 3).length() + former::device_type_text(kDevices[round % 5]).length();
+    }
+    switches = hostCycles() - start;
+
+    printf("4 texts: flash tables %llu cycles, switch with std::string %llu cycles\n",
+           (unsigned long long) (table / rounds), (unsigned long long) (switches / rounds));
+}
+
+int main()
+{
+    compare("tracking_mode_text", former::tracking_mode_text, tracking_mode_text);
+    compare("error_code_text", former::error_code_text, error_code_text);
+    compare("charging_mode_text", former::charging_mode_text, charging_mode_text);
+    compare("device_type_text", former::device_type_text, device_type_text);
+    /* "Unknown" is stored once */
+    printf("moved to flash on the ESP8266: %u bytes of texts, %u bytes of tables (%u entries)\n",
+           (unsigned int) (mTexts + sizeof("Unknown")), (unsigned int) (mEntries * ESP_ENTRY_SIZE), (unsigned int) mEntries);
+    benchmark();
+    return hostResult("bench_victron_texts");
+}
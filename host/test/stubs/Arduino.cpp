@@ -0,0 +1,11 @@
+/**
+ * @file Arduino.cpp
+ * @brief Time of the host tests
+ * @version 0.1
+ *
+ */
+
+#include <Arduino.h>
+
+uint32_t hostMillis = 1000;
+HardwareSerial Serial;
@@ -0,0 +1,125 @@
+/**
+ * @file Arduino.h
+ * @brief Minimal Arduino core for building the hardware independent modules on a Linux host
+ * @version 0.1
+ *
+ * Only, what the tested modules use: String, Stream, millis() and the PROGMEM accessors.
+ */
+
+#ifndef HOST_ARDUINO
+#define HOST_ARDUINO
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string>
+
+#define PROGMEM
+#define PGM_P               const char *
+#define PSTR(s)             (s)
+#define F(s)                (s)
+#define strcmp_P            strcmp
+#define strlen_P            strlen
+#define memcpy_P            memcpy
+#define pgm_read_byte(p)    (*(const uint8_t *) (p))
+#define pgm_read_word(p)    (*(const uint16_t *) (p))
+#define pgm_read_dword(p)   (*(const uint32_t *) (p))
+#define pgm_read_ptr(p)     (*(const void *const *) (p))
+
+extern uint32_t hostMillis;     /**< time of the host tests, advanced by the tests */
+
+inline uint32_t millis()
+{
+    return hostMillis;
+}
+
+inline void delay(unsigned long ms)
+{
+    hostMillis += ms;
+}
+
+class String
+{
+public:
+    String(const char *text = "") : text_(text ? text : "") {}
+    explicit String(int value) : text_(std::to_string(value)) {}
+    explicit String(unsigned int value) : text_(std::to_string(value)) {}
+    explicit String(long value) : text_(std::to_string(value)) {}
+    explicit String(unsigned long value) : text_(std::to_string(value)) {}
+
+    const char *c_str() const {
+        return text_.c_str();
+    }
+    unsigned int length() const {
+        return text_.size();
+    }
+    bool equals(const char *text) const {
+        return text_ == text;
+    }
+    String &operator+=(const String &other) {
+        text_ += other.text_;
+        return *this;
+    }
+    friend String operator+(const String &a, const String &b) {
+        String result(a);
+        result += b;
+        return result;
+    }
+    friend String operator+(const String &a, const char *b) {
+        return a + String(b);
+    }
+    friend String operator+(const char *a, const String &b) {
+        return String(a) + b;
+    }
+
+private:
+    std::string text_;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        size_t written = 0;
+        while (size--) {
+            written += write(*buffer++);
+        }
+        return written;
+    }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+};
+
+/** The hardware UART never receives anything on the host */
+class HardwareSerial : public Stream
+{
+public:
+    int available() override {
+        return 0;
+    }
+    int read() override {
+        return -1;
+    }
+    int peek() override {
+        return -1;
+    }
+    size_t write(uint8_t) override {
+        return 1;
+    }
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif /* End of HOST_ARDUINO */
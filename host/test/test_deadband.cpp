@@ -0,0 +1,101 @@
+/**
+ * @file test_deadband.cpp
+ * @brief Deadband: changes within and beyond the width, heartbeat, texts and the counters
+ * @version 0.1
+ *
+ */
+
+#include "HostTest.h"
+#include "Deadband.h"
+
+static void testWidth()
+{
+    Deadband temperature(10);   /* 0.1 °C in 0.01 °C */
+    uint32_t sent = Deadband::getSent();
+    uint32_t suppressed = Deadband::getSuppressed();
+
+    CHECK(temperature.check(2150));     /* first value is always published */
+    CHECK(!temperature.check(2160));    /* exactly the width */
+    CHECK(!temperature.check(2140));
+    CHECK(temperature.check(2161));
+    /* the published value is the reference, not the last checked one */
+    CHECK(!temperature.check(2170));
+    CHECK(!temperature.check(2171));
+    CHECK(temperature.check(2150));
+    CHECK(temperature.check(-2000));
+    CHECK_EQUAL(sent + 4, Deadband::getSent());
+    CHECK_EQUAL(suppressed + 4, Deadband::getSuppressed());
+}
+
+static void testZeroWidth()
+{
+    Deadband pm1;
+
+    CHECK(pm1.check(0L));
+    CHECK(!pm1.check(0L));
+    CHECK(pm1.check(1));
+    pm1.setWidth(2);
+    CHECK(!pm1.check(3));
+    CHECK(pm1.check(4));
+}
+
+static void testHeartbeat()
+{
+    Deadband pressure(50);
+
+    Deadband::setHeartbeat(60000);
+    CHECK_EQUAL(60000, Deadband::getHeartbeat());
+    CHECK(pressure.check(101325));
+    delay(59999);
+    CHECK(!pressure.check(101325));
+    delay(1);
+    CHECK(pressure.check(101325));
+    /* the heartbeat restarts with each publish */
+    delay(30000);
+    CHECK(pressure.check(101400));
+    delay(30000);
+    CHECK(!pressure.check(101400));
+    /* millis() overflows after 49 days */
+    hostMillis = 0xFFFFFFFFUL - 1000;
+    CHECK(pressure.check(101400));
+    delay(2000);
+    CHECK(!pressure.check(101400));
+    delay(58000);
+    CHECK(pressure.check(101400));
+    Deadband::setHeartbeat(DEADBAND_HEARTBEAT_DEFAULT);
+}
+
+static void testHeartbeatOnly()
+{
+    Deadband counter(DEADBAND_HEARTBEAT_ONLY);
+
+    CHECK(counter.check(0L));
+    CHECK(!counter.check(1000000));
+    CHECK(!counter.check(-1000000));
+    delay(DEADBAND_HEARTBEAT_DEFAULT);
+    CHECK(counter.check(1000001));
+}
+
+static void testText()
+{
+    Deadband status;
+
+    CHECK(status.check("10000"));
+    CHECK(!status.check("10000"));
+    CHECK(status.check("10001"));
+    CHECK(status.check("10000"));
+    CHECK(status.check(""));
+    CHECK(!status.check(""));
+    delay(DEADBAND_HEARTBEAT_DEFAULT);
+    CHECK(status.check(""));
+}
+
+int main()
+{
+    testWidth();
+    testZeroWidth();
+    testHeartbeat();
+    testHeartbeatOnly();
+    testText();
+    return hostResult("test_deadband");
+}
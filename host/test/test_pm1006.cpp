@@ -0,0 +1,185 @@
+/**
+ * @file test_pm1006.cpp
+ * @brief PM1006 receiver: clean, cut and corrupted streams; filter of the samples
+ * @version 0.1
+ *
+ */
+
+#include <cstdlib>
+#include "HostTest.h"
+#include "PM1006.h"
+
+/** Frame as sent by the sensor of the IKEA Vindriktning, with a valid checksum */
+static std::string frame(uint16_t pm25, uint16_t pm1 = 0, uint16_t pm10 = 0)
+{
+    uint8_t bytes[PM1006_FRAME_LENGTH] = { PM1006_HEADER, PM1006_LENGTH, PM1006_COMMAND };
+    uint8_t sum = 0;
+
+    bytes[5] = pm25 >> 8;
+    bytes[6] = pm25 & 0xFF;
+    bytes[9] = pm1 >> 8;
+    bytes[10] = pm1 & 0xFF;
+    bytes[13] = pm10 >> 8;
+    bytes[14] = pm10 & 0xFF;
+    bytes[16] = 0x01;
+    for (int i = 0; i < (PM1006_FRAME_LENGTH - 1); i++) {
+        sum += bytes[i];
+    }
+    bytes[PM1006_FRAME_LENGTH - 1] = 0x100 - sum;
+    return std::string((const char *) bytes, sizeof(bytes));
+}
+
+/** Parse everything; the values of all handed over frames */
+static std::vector<int> receive(PM1006 &sensor, HostStream &uart, const std::string &bytes)
+{
+    std::vector<int> values;
+    uart.input += bytes;
+    while (uart.available() > 0) {
+        sensor.loop();
+        if (sensor.hasFrame()) {
+            values.push_back(sensor.getFrame().getPM25());
+            sensor.release();
+        }
+    }
+    return values;
+}
+
+static void testFrames()
+{
+    HostStream uart;
+    PM1006 sensor(uart);
+    std::vector<int> values = receive(sensor, uart, frame(12, 7, 21) + frame(13) + frame(14));
+
+    CHECK_EQUAL(3, values.size());
+    CHECK_EQUAL(14, sensor.getFrame().getPM25());
+    CHECK_EQUAL(3, sensor.getGoodFrames());
+    CHECK_EQUAL(0, sensor.getBadFrames());
+    CHECK_EQUAL(0, sensor.getResyncs());
+    CHECK_EQUAL(0x00010000, sensor.getFrame().getStatus());
+}
+
+/* One call parses at most PM1006_BYTES_PER_LOOP bytes and stops at a completed frame, the rest stays in the serial */
+static void testByteBudget()
+{
+    HostStream uart;
+    PM1006 sensor(uart);
+
+    uart.input = std::string(40, '\0') + frame(1) + frame(2);
+    sensor.loop();
+    CHECK_EQUAL(PM1006_BYTES_PER_LOOP, uart.position);
+    sensor.loop();
+    CHECK_EQUAL(60, uart.position);
+    CHECK(sensor.hasFrame());
+    /* the frame is not replaced, before it is released */
+    sensor.loop();
+    CHECK_EQUAL(60, uart.position);
+    CHECK_EQUAL(1, sensor.getFrame().getPM25());
+    sensor.release();
+    sensor.loop();
+    CHECK_EQUAL(2, sensor.getFrame().getPM25());
+    CHECK_EQUAL(2, sensor.getGoodFrames());
+}
+
+/* Reception starts within a frame, a frame is cut and one is corrupted */
+static void testCorrupted()
+{
+    HostStream uart;
+    PM1006 sensor(uart);
+    std::string corrupted = frame(500);
+    std::string values;
+
+    corrupted[6] ^= 0x40;
+    std::vector<int> received = receive(sensor, uart,
+        frame(10).substr(7) +                       /* started in the middle */
+        frame(11) +
+        frame(12).substr(0, 9) +                    /* cut after the header */
+        frame(13) +
+        corrupted +
+        std::string("\x16\x11", 2) +                /* header without command */
+        frame(14));
+    for (int value : received) {
+        values += std::to_string(value) + " ";
+    }
+    CHECK_TEXT("11 13 14 ", values);
+    CHECK_EQUAL(3, sensor.getGoodFrames());
+    CHECK_EQUAL(2, sensor.getBadFrames());
+    CHECK(sensor.getResyncs() >= 2);
+}
+
+/* Random damage: a frame is only handed over with a valid checksum and one of the sent values */
+static void testRandomDamage()
+{
+    HostStream uart;
+    PM1006 sensor(uart);
+    std::string stream;
+    int accepted = 0;
+
+    srand(1006);
+    for (int i = 0; i < 2000; i++) {
+        std::string bytes = frame(100 + (i % 50));
+        switch (rand() % 8) {
+        case 0:
+            bytes[rand() % bytes.size()] ^= (1 << (rand() % 8));
+            break;
+        case 1:
+            bytes.resize(rand() % bytes.size());
+            break;
+        case 2:
+            bytes.insert(rand() % bytes.size(), 1, (char) (rand() & 0xFF));
+            break;
+        default:
+            break;
+        }
+        stream += bytes;
+    }
+    uart.input = stream;
+    while (uart.available() > 0) {
+        sensor.loop();
+        if (sensor.hasFrame()) {
+            const uint8_t *bytes = sensor.getFrame().getBytes();
+            uint8_t sum = 0;
+            for (int i = 0; i < PM1006_FRAME_LENGTH; i++) {
+                sum += bytes[i];
+            }
+            CHECK_EQUAL(0, sum);
+            CHECK((sensor.getFrame().getPM25() >= 100) && (sensor.getFrame().getPM25() < 150));
+            accepted++;
+            sensor.release();
+        }
+    }
+    /* 5 of 8 frames are sent undamaged */
+    CHECK(accepted >= 1100);
+    CHECK_EQUAL(accepted, sensor.getGoodFrames());
+    printf("random damage: %d of 2000 frames accepted, %u bad, %u resyncs\n", accepted,
+           (unsigned int) sensor.getBadFrames(), (unsigned int) sensor.getResyncs());
+}
+
+/* Out of range values and single jumps are rejected, a lasting jump is accepted */
+static void testFilter()
+{
+    PM1006Filter filter(1000);
+
+    CHECK_EQUAL(-1, filter.getFiltered());
+    CHECK(filter.add(10));
+    CHECK(filter.add(12));
+    CHECK(!filter.add(1001));
+    CHECK(!filter.add(-1));
+    CHECK(!filter.add(400));
+    CHECK_EQUAL(3, filter.getRejected());
+    CHECK(filter.getFiltered() < 20);
+    CHECK(!filter.add(400));
+    CHECK(filter.add(400));
+    CHECK_EQUAL(4, filter.getRejected());
+    CHECK_EQUAL(400, filter.getFiltered());
+    CHECK_EQUAL(3, filter.getWindowSamples());
+}
+
+int main()
+{
+    testFrames();
+    testByteBudget();
+    testCorrupted();
+    testRandomDamage();
+    testFilter();
+    return hostResult("test_pm1006");
+}
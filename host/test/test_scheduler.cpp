@@ -0,0 +1,121 @@
+/**
+ * @file test_scheduler.cpp
+ * @brief Scheduler: phases, one task per loop, skipped periods and overruns
+ * @version 0.1
+ *
+ */
+
+#include "HostTest.h"
+#include "Scheduler.h"
+
+static std::string executed;        /**< names of the executed tasks */
+static uint32_t taskDuration = 0;   /**< ms, each task needs */
+static std::vector<std::string> overruns;
+
+static void taskA()
+{
+    executed += "A";
+    delay(taskDuration);
+}
+
+static void taskB()
+{
+    executed += "B";
+    delay(taskDuration);
+}
+
+static void onOverrun(const char *name, uint32_t duration, uint32_t budget)
+{
+    overruns.push_back(std::string(name) + " " + std::to_string(duration) + "/" + std::to_string(budget));
+}
+
+/** Call loop() each millisecond */
+static void run(Scheduler &scheduler, uint32_t ms)
+{
+    for (uint32_t i = 0; i < ms; i++) {
+        scheduler.loop();
+        delay(1);
+    }
+}
+
+static void testPhases()
+{
+    Scheduler scheduler;
+
+    hostMillis = 5000;
+    executed.clear();
+    CHECK_EQUAL(0, scheduler.add("a", taskA, 100, 0, 10));
+    CHECK_EQUAL(1, scheduler.add("b", taskB, 100, 50, 10));
+    /* the phases are relative to the first loop */
+    run(scheduler, 300);
+    CHECK_TEXT("ABABAB", executed);
+    CHECK_EQUAL(5300, scheduler.getNextRun(0));
+    CHECK_EQUAL(5350, scheduler.getNextRun(1));
+}
+
+static void testOneTaskPerLoop()
+{
+    Scheduler scheduler;
+
+    executed.clear();
+    scheduler.add("a", taskA, 100, 0, 10);
+    scheduler.add("b", taskB, 100, 0, 10);
+    CHECK(scheduler.loop());
+    CHECK_TEXT("A", executed);
+    CHECK(scheduler.loop());
+    CHECK_TEXT("AB", executed);
+    CHECK(!scheduler.loop());
+}
+
+static void testSkipped()
+{
+    Scheduler scheduler;
+
+    executed.clear();
+    scheduler.add("a", taskA, 100, 0, 10);
+    CHECK(scheduler.loop());
+    /* more than one period late: executed once, the next execution is one period later */
+    delay(350);
+    CHECK(scheduler.loop());
+    CHECK(!scheduler.loop());
+    CHECK_TEXT("AA", executed);
+    CHECK_EQUAL(hostMillis + 100, scheduler.getNextRun(0));
+}
+
+static void testOverrun()
+{
+    Scheduler scheduler;
+
+    executed.clear();
+    overruns.clear();
+    scheduler.onOverrun(onOverrun);
+    scheduler.add("a", taskA, 100, 0, 10);
+    scheduler.add("b", taskB, 100, 0, 30);
+    taskDuration = 20;
+    CHECK(scheduler.loop());
+    CHECK(scheduler.loop());
+    taskDuration = 0;
+    CHECK_EQUAL(1, scheduler.getOverruns());
+    CHECK_EQUAL(1, overruns.size());
+    CHECK_TEXT("a 20/10", overruns.empty() ? "" : overruns[0]);
+}
+
+static void testLimit()
+{
+    Scheduler scheduler;
+
+    for (int i = 0; i < SCHEDULER_TASKS; i++) {
+        CHECK_EQUAL(i, scheduler.add("a", taskA, 100, 0, 10));
+    }
+    CHECK_EQUAL(-1, scheduler.add("a", taskA, 100, 0, 10));
+}
+
+int main()
+{
+    testPhases();
+    testOneTaskPerLoop();
+    testSkipped();
+    testOverrun();
+    testLimit();
+    return hostResult("test_scheduler");
+}
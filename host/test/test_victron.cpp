@@ -0,0 +1,168 @@
+/**
+ * @file test_victron.cpp
+ * @brief VE.Direct text parser: recorded capture, byte budget, overlong fields, HEX frames and raw debug lines
+ * @version 0.1
+ *
+ */
+
+#include "HostTest.h"
+#include "victron.h"
+
+/** Frame of the text protocol with a valid checksum, e.g. { "V", "12800" } */
+static std::string textFrame(const std::vector<std::pair<std::string, std::string>> &fields)
+{
+    std::string frame;
+    uint8_t sum = 0;
+    for (const auto &field : fields) {
+        frame += "\r\n" + field.first + "\t" + field.second;
+    }
+    frame += "\r\nChecksum\t";
+    for (char c : frame) {
+        sum += (uint8_t) c;
+    }
+    frame += (char) (0x100 - sum);
+    return frame;
+}
+
+/** Parse everything received, the time advances by 10 ms per call; the charger sends one frame per second */
+static void receive(victron::VictronComponent &charger, HostStream &uart, const std::string &bytes)
+{
+    uart.input += bytes;
+    while (uart.available() > 0) {
+        charger.loop();
+        hostMillis += 10;
+    }
+    charger.loop();
+    hostMillis += 1000;
+}
+
+static std::string json(victron::VictronComponent &charger)
+{
+    char buffer[VICTRON_JSON_MAX];
+    charger.toJson(buffer, sizeof(buffer));
+    return buffer;
+}
+
+/* The values of the last frame of host/VictronDummyData.txt; the same values were produced
+ * by the parser before the fixed buffers (load 1, max. power 12/10 W, yield 80/110/90 Wh, ...) */
+static void testDummyData()
+{
+    HostStream uart;
+    victron::VictronComponent charger(uart);
+
+    receive(charger, uart, hostReadFile("VictronDummyData.txt"));
+    CHECK_EQUAL(2, charger.getGoodFrames());
+    CHECK_EQUAL(0, charger.getBadFrames());
+    CHECK_EQUAL(0, charger.getTruncatedFrames());
+    CHECK_EQUAL(0, charger.getOverlongFields());
+    CHECK_EQUAL(0, charger.getUnknownLabels());
+    CHECK_TEXT("{\"mode\":\"newdata\",\"load\":1,\"MaxPower\":{\"yesterday\":12,\"today\":10},"
+               "\"Yield\":{\"Total\":80.00,\"Yesterday\":110.00,\"Today\":90.00},"
+               "\"Panel\":{\"Voltage\":2,\"Power\":3},\"Bat\":{\"Voltage\":26310,\"Current\":1},"
+               "\"LoadCurrent\":7,\"DayNumber\":13,\"ChargingModeID\":4,\"ErrorCode\":6,\"TrackingModeID\":5,"
+               "\"LoadControl\":-1,\"ErrorText\":\"Unknown\",\"TrackingMode\":\"Unknown\","
+               "\"ChargingMode\":\"Absorption\",\"DeviceType\":\"BlueSolar MPPT 75|10\"}", json(charger));
+}
+
+/* A burst is parsed in several calls */
+static void testByteBudget()
+{
+    HostStream uart;
+    victron::VictronComponent charger(uart);
+
+    uart.input = hostReadFile("VictronDummyData.txt");
+    charger.loop();
+    CHECK_EQUAL(VICTRON_BYTES_PER_LOOP, uart.position);
+    CHECK_EQUAL(VICTRON_BYTES_PER_LOOP, charger.getBytesReceived());
+}
+
+/* Cut fields are never interpreted: their frame is dropped, the next one is used */
+static void testOverlongField()
+{
+    HostStream uart;
+    victron::VictronComponent charger(uart);
+
+    /* the values of the first frame after the start are skipped */
+    receive(charger, uart, textFrame({ { "V", "11000" } }));
+    receive(charger, uart, textFrame({ { "V", "12000" } }));
+    receive(charger, uart, textFrame({ { "V", "12100" }, { "FW", std::string(VICTRON_VALUE_MAX + 1, '1') } }));
+    CHECK_EQUAL(1, charger.getOverlongFields());
+    CHECK_EQUAL(1, charger.getTruncatedFrames());
+    receive(charger, uart, textFrame({ { "V", "12200" }, { "LabelTooLong", "1" } }));
+    CHECK_EQUAL(2, charger.getOverlongFields());
+    CHECK_EQUAL(2, charger.getTruncatedFrames());
+    CHECK_EQUAL(12, charger.getBatteryVoltage());
+    receive(charger, uart, textFrame({ { "V", "13300" }, { "XYZ", "1" } }));
+    CHECK_EQUAL(3, charger.getGoodFrames());
+    CHECK_EQUAL(1, charger.getUnknownLabels());
+    CHECK_EQUAL(13, charger.getBatteryVoltage());
+    CHECK_EQUAL(13300, charger.getBatteryMillivolt());
+}
+
+/* HEX frames are not part of the text protocol: neither between text frames nor at the start of a line */
+static void testHexFrames()
+{
+    HostStream uart;
+    victron::VictronComponent charger(uart);
+    const std::string hex = ":7ABED0002B4\n";    /* load output control: on */
+
+    hostLog.clear();
+
+    receive(charger, uart, textFrame({ { "V", "11000" } }));
+    receive(charger, uart, textFrame({ { "V", "12000" } }));
+    receive(charger, uart, hex);
+    receive(charger, uart, hex);
+    receive(charger, uart, textFrame({ { "V", "12100" } }) + hex);
+    std::string frame = textFrame({ { "V", "12200" }, { "I", "500" } });
+    frame.insert(frame.find("I\t"), hex);
+    receive(charger, uart, frame);
+    CHECK_EQUAL(0, charger.getTruncatedFrames());
+    CHECK_EQUAL(0, charger.getBadFrames());
+    CHECK_EQUAL(4, charger.getGoodFrames());
+    CHECK_EQUAL(12, charger.getBatteryVoltage());
+    for (const std::string &message : hostLog) {
+        CHECK(message.find("Last transmission too long ago") == std::string::npos);
+    }
+}
+
+static bool mDebugAccepted = true;
+static std::vector<std::string> mDebugBlocks;
+
+static bool debugBlock(const char *lines)
+{
+    mDebugBlocks.push_back(lines);
+    return mDebugAccepted;
+}
+
+/* The raw lines are sent in blocks; lines of a block, which is not logged, are counted as dropped */
+static void testDebugDropped()
+{
+    HostStream uart;
+    victron::VictronComponent charger(uart);
+
+    charger.activateDebugging(debugBlock);
+    receive(charger, uart, textFrame({ { "V", "12000" }, { "I", "100" } }) + "\r\n");
+    hostMillis += VICTRON_DEBUG_INTERVAL;
+    charger.loop();
+    CHECK_EQUAL(1, mDebugBlocks.size());
+    CHECK(mDebugBlocks.back().find("V\t12000\nI\t100\nChecksum\t") == 0);
+    CHECK_EQUAL(0, charger.getDebugDropped());
+
+    mDebugAccepted = false;
+    receive(charger, uart, textFrame({ { "V", "12100" } }).substr(2) + "\r\n");
+    hostMillis += VICTRON_DEBUG_INTERVAL;
+    charger.loop();
+    CHECK_EQUAL(2, mDebugBlocks.size());
+    CHECK_EQUAL(2, charger.getDebugDropped());
+    charger.activateDebugging(NULL);
+}
+
+int main()
+{
+    testDummyData();
+    testByteBudget();
+    testOverlongField();
+    testHexFrames();
+    testDebugDropped();
+    return hostResult("test_victron");
+}
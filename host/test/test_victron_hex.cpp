@@ -0,0 +1,150 @@
+/**
+ * @file test_victron_hex.cpp
+ * @brief VE.Direct HEX protocol: frames, responses, timeouts with retries and the request queue
+ * @version 0.1
+ *
+ */
+
+#include <algorithm>
+#include "HostTest.h"
+#include "VictronHex.h"
+
+/** Amount of sent frames */
+static long frames(const HostStream &port)
+{
+    return std::count(port.output.begin(), port.output.end(), '\n');
+}
+
+/** Received frame without ':' and '\n' */
+static bool receive(victron::VictronHex &hex, const char *frame, victron::VictronHexResponse &response)
+{
+    return hex.receive(frame, strlen(frame), response);
+}
+
+static void testEncoding()
+{
+    HostStream port;
+    victron::VictronHex hex(port);
+
+    CHECK(hex.get(VICTRON_REG_LOAD_OUTPUT_CONTROL));
+    hex.loop(0);
+    CHECK_TEXT(":7ABED00B6\n", port.output);
+    port.output.clear();
+    /* the same register with SET is a further request, its value is sent little endian */
+    CHECK(hex.set(VICTRON_REG_LOAD_OUTPUT_CONTROL, 4, 1));
+    hex.loop(0);
+    CHECK_TEXT(":8ABED0004B1\n", port.output);
+    port.output.clear();
+    CHECK(hex.set(0x1234, 0x0A0B, 2));
+    hex.loop(0);
+    CHECK_TEXT(":8341200" "0B0A" "F2\n", port.output);
+}
+
+static void testResponse()
+{
+    HostStream port;
+    victron::VictronHex hex(port);
+    victron::VictronHexResponse response;
+
+    CHECK(hex.get(VICTRON_REG_LOAD_OUTPUT_CONTROL));
+    hex.loop(0);
+    /* answer of another register: valid, but no request is completed */
+    CHECK(receive(hex, "7000100024B", response));
+    CHECK_EQUAL(0x0100, response.reg);
+    CHECK_EQUAL(0, hex.getResponses());
+    CHECK(receive(hex, "7ABED0002B4", response));
+    CHECK_EQUAL(VICTRON_HEX_CMD_GET, response.command);
+    CHECK_EQUAL(VICTRON_REG_LOAD_OUTPUT_CONTROL, response.reg);
+    CHECK_EQUAL(0, response.flags);
+    CHECK_EQUAL(2, response.value);
+    CHECK_EQUAL(1, hex.getResponses());
+    /* the answered request is not repeated */
+    hex.loop(VICTRON_HEX_TIMEOUT * 10);
+    CHECK_EQUAL(1, frames(port));
+    CHECK_EQUAL(0, hex.getTimeouts());
+    /* asynchronous messages of the charger are accepted as well */
+    CHECK(receive(hex, "AABED0004AF", response));
+    CHECK_EQUAL(VICTRON_HEX_CMD_ASYNC, response.command);
+    CHECK_EQUAL(4, response.value);
+}
+
+static void testTimeout()
+{
+    HostStream port;
+    victron::VictronHex hex(port);
+    uint32_t now = 0;
+
+    CHECK(hex.get(0x0100));
+    hex.loop(now);
+    CHECK_TEXT(":70001004D\n", port.output);
+    hex.loop(now + VICTRON_HEX_TIMEOUT - 1);
+    CHECK_EQUAL(1, frames(port));
+    for (int retry = 1; retry <= VICTRON_HEX_RETRIES; retry++) {
+        now += VICTRON_HEX_TIMEOUT;
+        hex.loop(now);
+        CHECK_EQUAL(1 + retry, frames(port));
+        CHECK_EQUAL(retry, hex.getTimeouts());
+        CHECK_EQUAL(0, hex.getFailures());
+    }
+    /* all retries are used: dropped */
+    now += VICTRON_HEX_TIMEOUT;
+    hex.loop(now);
+    CHECK_EQUAL(1 + VICTRON_HEX_RETRIES, frames(port));
+    CHECK_EQUAL(VICTRON_HEX_RETRIES + 1, hex.getTimeouts());
+    CHECK_EQUAL(1, hex.getFailures());
+    hex.loop(now + VICTRON_HEX_TIMEOUT * 10);
+    CHECK_EQUAL(1 + VICTRON_HEX_RETRIES, frames(port));
+}
+
+static void testQueue()
+{
+    HostStream port;
+    victron::VictronHex hex(port);
+    victron::VictronHexResponse response;
+
+    for (int i = 0; i < VICTRON_HEX_QUEUE; i++) {
+        CHECK(hex.get(0x0100 + i));
+    }
+    /* a pending GET of the same register delivers the value, a further one is rejected */
+    CHECK(hex.get(0x0100));
+    CHECK(!hex.get(0x0200));
+    CHECK(!hex.set(0x0200, 1, 1));
+
+    /* only some requests wait for their response at the same time */
+    hex.loop(0);
+    CHECK_EQUAL(VICTRON_HEX_INFLIGHT, frames(port));
+    hex.loop(1);
+    CHECK_EQUAL(VICTRON_HEX_INFLIGHT, frames(port));
+    /* a response frees the slot of its request, the next one is sent */
+    CHECK(receive(hex, "7000100024B", response));
+    CHECK(hex.get(0x0200));
+    hex.loop(2);
+    CHECK_EQUAL(VICTRON_HEX_INFLIGHT + 1, frames(port));
+}
+
+static void testInvalid()
+{
+    HostStream port;
+    victron::VictronHex hex(port);
+    victron::VictronHexResponse response;
+
+    CHECK(!receive(hex, "7ABED0002B5", response));     /* checksum */
+    CHECK(!receive(hex, "7ABED0002B", response));      /* odd amount of digits */
+    CHECK(!receive(hex, "7ABED00X2B4", response));     /* no hex digit */
+    CHECK(!receive(hex, "", response));
+    CHECK_EQUAL(4, hex.getInvalidFrames());
+    /* valid, but no register value (ping answer) */
+    CHECK(!receive(hex, "51641F9", response));
+    CHECK_EQUAL(4, hex.getInvalidFrames());
+    CHECK_EQUAL(0, hex.getResponses());
+}
+
+int main()
+{
+    testEncoding();
+    testResponse();
+    testTimeout();
+    testQueue();
+    testInvalid();
+    return hostResult("test_victron_hex");
+}
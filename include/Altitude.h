@@ -0,0 +1,22 @@
+/**
+ * @file Altitude.h
+ * @brief Altitude of the measured pressure, without pow()
+ * @version 0.1
+ *
+ * The altitude is interpolated in a table, calculated with the formula of readAltitude()
+ * of the Adafruit libraries: 44330 * (1 - (p / 1013.25 hPa) ^ 0.1903)
+ */
+
+#ifndef ALTITUDE_TABLE
+#define ALTITUDE_TABLE
+
+#include <stdint.h>
+
+#define SEALEVELPRESSURE_HPA    (1013.25)   /**< Reference of the table */
+#define ALTITUDE_PRESSURE_MIN   30000       /**< Pa, first entry of the table */
+#define ALTITUDE_PRESSURE_MAX   110000      /**< Pa, last entry of the table */
+#define ALTITUDE_PRESSURE_STEP  1000        /**< Pa between two entries of the table */
+
+int32_t altitudeFromPressure(int32_t pressure);
+
+#endif /* End of ALTITUDE_TABLE */
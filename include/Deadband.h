@@ -0,0 +1,61 @@
+/**
+ * @file Deadband.h
+ * @brief Decides, if a property needs to be published again
+ * @version 0.1
+ *
+ * A value is published, if it differs more than the deadband from the last published one
+ * or if the heartbeat interval elapsed since then.
+ * Values and deadbands are scaled integers in the same unit (e.g. 0.01 °C).
+ */
+
+#ifndef DEADBAND_PUBLISH
+#define DEADBAND_PUBLISH
+
+#include <stdint.h>
+#include <limits.h>
+#include <Arduino.h>
+
+#define DEADBAND_HEARTBEAT_DEFAULT  300000  /**< Publish at least every five minutes */
+#define DEADBAND_HEARTBEAT_ONLY     LONG_MAX /**< Width for values, which are only published with the heartbeat (e.g. counters) */
+
+class Deadband
+{
+public:
+    Deadband(long width = 0) : width_(width) {
+    }
+
+    void setWidth(long width) {
+        width_ = width;
+    }
+
+    bool check(long value);
+    bool check(const char *text);
+
+    static void setHeartbeat(uint32_t interval) {
+        heartbeat_ = interval;
+    }
+    static uint32_t getHeartbeat() {
+        return heartbeat_;
+    }
+    static uint32_t getSent() {
+        return sent_;
+    }
+    static uint32_t getSuppressed() {
+        return suppressed_;
+    }
+
+private:
+    bool due_(bool changed);
+
+    long width_;
+    long last_ = 0;
+    uint32_t last_hash_ = 0;
+    uint32_t sent_at_ = 0;
+    bool valid_ = false;        /**< something was published */
+
+    static uint32_t heartbeat_;
+    static uint32_t sent_;
+    static uint32_t suppressed_;
+};
+
+#endif /* End of DEADBAND_PUBLISH */
@@ -0,0 +1,21 @@
+/**
+ * @file Format.h
+ * @brief Numbers as text into a buffer of the caller, without String and dtostrf()
+ * @version 0.1
+ *
+ * Decimal values are given as scaled integers, e.g. 2153 with 2 decimals is "21.53".
+ */
+
+#ifndef FORMAT_NUMBER
+#define FORMAT_NUMBER
+
+#include <stdint.h>
+
+#define FORMAT_NUMBER_MAX   16      /**< Buffer for sign, 10 digits, decimal point and terminator */
+#define FORMAT_DECIMALS_MAX 6       /**< Decimals of formatScaled() */
+
+char *formatNumber(char *buffer, long value, uint8_t decimals = 0);
+char *formatUnsigned(char *buffer, unsigned long value, uint8_t base = 10);
+char *formatScaled(char *buffer, long value, uint8_t scale, uint8_t decimals);
+
+#endif /* End of FORMAT_NUMBER */
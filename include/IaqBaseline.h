@@ -0,0 +1,56 @@
+/**
+ * @file IaqBaseline.h
+ * @brief Air quality index from the gas resistance and humidity of the BME680
+ * @version 0.1
+ *
+ * The gas resistance in clean air (baseline) is tracked with a moving average:
+ * higher values are followed quickly, lower ones very slowly.
+ * The index combines the distance to this baseline (75%) and to a humidity of 40% (25%):
+ * 0 is excellent, 500 is the worst air quality.
+ *
+ * The baseline is kept in RTC memory (deep sleep, reset) and saved from time to time in the filesystem (power loss),
+ * so no new burn-in is needed after a wake up.
+ */
+
+#ifndef IAQ_BASELINE
+#define IAQ_BASELINE
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define IAQ_HUMIDITY_BASELINE   400     /**< 0.1 % relative humidity, the optimum */
+#define IAQ_HUMIDITY_WEIGHT     25      /**< Part of the humidity in the score (%) */
+#define IAQ_RISE_SHIFT          3       /**< Baseline follows higher gas resistance with 1/8 */
+#define IAQ_FALL_SHIFT          12      /**< and lower gas resistance with 1/4096 */
+#define IAQ_BURN_IN             10      /**< Samples, before the index is calculated */
+#define IAQ_SAVE_SAMPLES        120     /**< Save the baseline in the filesystem every 120 samples (one hour with 30 s) */
+#define IAQ_RTC_OFFSET          96      /**< RTC block, behind the log records (MQTT_LOG_RTC_END) */
+#define IAQ_FILE                "/iaq.bin"
+
+class IaqBaseline
+{
+public:
+    void begin();
+    int update(uint32_t gas, int32_t humidity);
+
+    /** @return Gas resistance in clean air in Ohm, 0 if unknown */
+    uint32_t getBaseline() {
+        return state_.baseline;
+    }
+    uint32_t getSamples() {
+        return state_.samples;
+    }
+
+private:
+    struct State {
+        uint32_t magic;
+        uint32_t baseline;
+        uint32_t samples;
+    };
+
+    void store_();
+
+    State state_ = { 0, 0, 0 };
+};
+
+#endif /* End of IAQ_BASELINE */
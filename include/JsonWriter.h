@@ -0,0 +1,63 @@
+/**
+ * @file JsonWriter.h
+ * @brief Streaming JSON serializer into a fixed buffer
+ * @version 0.1
+ *
+ * Nothing is allocated: the document is written directly into the buffer of the caller.
+ * If the buffer is too small, the document is marked as overflowed.
+ */
+
+#ifndef JSON_WRITER
+#define JSON_WRITER
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Arduino.h>
+
+class JsonWriter
+{
+public:
+    JsonWriter(char *buffer, size_t size);
+
+    void beginObject(const char *key = NULL);
+    void endObject();
+    void beginArray(const char *key = NULL);
+    void endArray();
+    void add(const char *key, long value);
+    void add(const char *key, const char *text);
+    void addP(const char *key, PGM_P text);
+    void addFixed(const char *key, long value, uint8_t decimals);
+
+    /**
+     * @brief Length of the document
+     * @return 0 if the buffer was too small
+     */
+    size_t length() {
+        return overflow_ ? 0 : length_;
+    }
+
+    bool overflow() {
+        return overflow_;
+    }
+
+    /** Position between two elements, e.g. to remove an element again, which did not fit */
+    size_t mark() {
+        return length_;
+    }
+    void rewind(size_t mark);
+
+private:
+    void key_(const char *key);
+    void char_(char c);
+    void raw_(const char *text);
+    void escaped_(char c);
+    void number_(long value, uint8_t decimals);
+
+    char *buffer_;
+    size_t size_;
+    size_t length_ = 0;
+    bool overflow_ = false;
+    bool comma_ = false;    /**< next element needs a separator */
+};
+
+#endif /* End of JSON_WRITER */
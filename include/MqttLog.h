@@ -9,7 +9,7 @@
 #ifndef MQTT_LOGGER
 #define MQTT_LOGGER
 
-#include <Homie.h>
+#include <Arduino.h>
 
 #define LOG_TOPIC "log\0"
 #define MQTT_LEVEL_ERROR    1
@@ -17,6 +17,45 @@
 #define MQTT_LEVEL_INFO     20
 #define MQTT_LEVEL_DEBUG    90
 
+#define MQTT_LOG_QUEUE_SIZE     1536    /**< Bytes of log records, waiting to be published */
+#define MQTT_LOG_MESSAGE_MAX    448     /**< Longer messages are truncated; a block of raw VE.Direct lines always fits */
+#define MQTT_LOG_BATCH_SIZE     1024    /**< Longest JSON array, published at once */
+#define MQTT_LOG_FLUSH_SIZE     768     /**< Publish immediately, if this amount of bytes is queued */
+#define MQTT_LOG_FLUSH_INTERVAL 1000    /**< Publish the queued records at least every second */
+#define MQTT_LOG_TOPIC_MAX      96
+
+/* Rate limit of repeated messages (same status code and text); debug messages are not limited */
+#define MQTT_LOG_LIMIT_SLOTS    8       /**< Messages, limited at the same time */
+#define MQTT_LOG_LIMIT_BURST    3       /**< Repeats, logged at once */
+#define MQTT_LOG_LIMIT_INTERVAL 10000   /**< Afterwards one message per interval, the others are counted */
+#define MQTT_LOG_LIMIT_TEXT     40      /**< Characters of the message, kept for the report of the repeats */
+
+/* Optional copy of the log records before MQTT is connected in RTC user memory (build flag MQTT_LOG_RTC),
+ * surviving deep sleep and resets. Blocks of 4 bytes; Homie uses a few blocks starting at 10.
+ */
+#define MQTT_LOG_RTC_OFFSET     32      /**< First block */
+#define MQTT_LOG_RTC_END        96      /**< First block after the log area */
+#define MQTT_LOG_RTC_RECORDS    7
+#define MQTT_LOG_RTC_MESSAGE    24      /**< Stored characters of each message */
+
+/* QoS of a published batch: the highest one of its records */
+#ifndef MQTT_LOG_QOS_ERROR
+#define MQTT_LOG_QOS_ERROR      1
+#endif
+#ifndef MQTT_LOG_QOS_WARNING
+#define MQTT_LOG_QOS_WARNING    1
+#endif
+#ifndef MQTT_LOG_QOS_INFO
+#define MQTT_LOG_QOS_INFO       0
+#endif
+#ifndef MQTT_LOG_QOS_DEBUG
+#define MQTT_LOG_QOS_DEBUG      0
+#endif
+
+#ifndef MQTT_LOG_LEVEL
+#define MQTT_LOG_LEVEL      MQTT_LEVEL_DEBUG    /**< Messages above this level are removed at compile time */
+#endif
+
 #define MQTT_LOG_PM1006     10
 #define MQTT_LOG_I2CINIT    100
 #define MQTT_LOG_I2READ     101
@@ -24,8 +63,40 @@
 
 #define MQTT_LOG_VICTRON    400
 
+#define MQTT_LOG_LOGGER     500
+
+#define MQTT_LOG_SCHEDULER  600
+
 extern bool mConnected;
+extern long mLogLevel;          /**< Messages above this level are dropped at runtime */
+
+bool log(int level, String message, int statusCode);
+void logSetup();
+void logConnected();
+void logLoop();
+void logFlush();
+uint32_t logDropped();
+uint32_t logSuppressed();
+uint32_t logBatches();
 
-void log(int level, String message, int statusCode);
+/**
+ * @brief Check, if messages of the given level are logged.
+ * With a constant level the check against MQTT_LOG_LEVEL is evaluated by the compiler.
+ */
+inline bool logEnabled(int level)
+{
+  return (level <= MQTT_LOG_LEVEL) && (level <= mLogLevel);
+}
+
+/**
+ * Lazy logging: the message (and everything needed to build it) is only evaluated,
+ * if the level is enabled.
+ */
+#define LOG(level, message, statusCode)         \
+  do {                                          \
+    if (logEnabled(level)) {                    \
+      log((level), (message), (statusCode));    \
+    }                                           \
+  } while (0)
 
 #endif /* end of MQTT_LOGGER */
\ No newline at end of file
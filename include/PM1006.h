@@ -0,0 +1,159 @@
+/**
+ * @file PM1006.h
+ * @brief Non-blocking receiver of the PM1006 particle sensor
+ * @version 0.1
+ *
+ * The bytes are parsed directly from the (software) serial in small portions with every loop,
+ * its receive buffer holds the rest. A state machine searches the header 0x16 0x11 0x0B in the stream,
+ * so a frame is found even if the reception started in the middle of another one.
+ * A frame is handed over, only if it was received completely and its checksum is valid
+ * (the sum of all 20 bytes is zero). Parsing pauses, until the frame was released.
+ */
+
+#ifndef PM1006_RECEIVER
+#define PM1006_RECEIVER
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define PM1006_FRAME_LENGTH     20      /**< Header (3 bytes), payload (16 bytes) and checksum */
+#define PM1006_BYTES_PER_LOOP   32      /**< Maximum bytes read from the serial within one loop */
+
+#define PM1006_FILTER_SAMPLES   5       /**< Median over the latest samples */
+#define PM1006_FILTER_EMA_SHIFT 2       /**< Weight of a new median in the moving average: 1/4 */
+#define PM1006_FILTER_MAX_JUMP  150     /**< Largest believable change between two samples */
+#define PM1006_FILTER_REJECTS   3       /**< Accept a jump, if it is seen this often in a row */
+
+#define PM1006_HEADER           0x16
+#define PM1006_LENGTH           0x11    /**< Length byte: command and payload */
+#define PM1006_COMMAND          0x0B
+
+/**
+ * @brief Typed view on a received frame (PM1006K layout); the bytes stay in the receive buffer
+ *
+ * DF1..DF16 follow the header, the values are big endian:
+ * DF3-DF4 PM2.5, DF7-DF8 PM1.0, DF11-DF12 PM10, DF13-DF16 status (not documented)
+ */
+class PM1006Frame
+{
+public:
+    PM1006Frame(const uint8_t *bytes) : bytes_(bytes) {
+    }
+
+    uint16_t getPM25() const {
+        return word_(5);
+    }
+    uint16_t getPM1() const {
+        return word_(9);
+    }
+    uint16_t getPM10() const {
+        return word_(13);
+    }
+    uint32_t getStatus() const {
+        return (((uint32_t) word_(15)) << 16) | word_(17);
+    }
+    const uint8_t *getBytes() const {
+        return bytes_;
+    }
+
+private:
+    uint16_t word_(uint8_t offset) const {
+        return (bytes_[offset] << 8) | bytes_[offset + 1];
+    }
+
+    const uint8_t *bytes_;
+};
+
+class PM1006
+{
+public:
+    PM1006(Stream &source);
+
+    void loop();
+    void receive(uint8_t c);
+
+    /** A new frame was received, since the last release() */
+    bool hasFrame() {
+        return frame_ready_;
+    }
+    void release() {
+        frame_ready_ = false;
+    }
+    /** Latest valid frame; stays valid until the next one is received */
+    PM1006Frame getFrame() {
+        return PM1006Frame(frames_buf_[ready_]);
+    }
+
+    uint32_t getGoodFrames() {
+        return good_frames_;
+    }
+    uint32_t getBadFrames() {
+        return bad_frames_;
+    }
+    uint32_t getResyncs() {
+        return resyncs_;
+    }
+
+private:
+    enum { STATE_HEADER = 0, STATE_LENGTH, STATE_COMMAND, STATE_PAYLOAD };
+
+    void end_frame_();
+
+    Stream &source_;
+
+    /* one frame is received, while the other one is handed over */
+    uint8_t frames_buf_[2][PM1006_FRAME_LENGTH] = { { 0 } };
+    uint8_t ready_ = 0;
+    uint8_t state_ = STATE_HEADER;
+    uint8_t length_ = 0;            /**< bytes of the frame in reception */
+    uint8_t checksum_ = 0;
+    bool skipped_ = false;          /**< bytes were dropped, searching the next header */
+    bool frame_ready_ = false;
+
+    uint32_t good_frames_ = 0;
+    uint32_t bad_frames_ = 0;       /**< invalid checksum */
+    uint32_t resyncs_ = 0;          /**< headers found after dropping bytes */
+};
+
+/**
+ * @brief Smoothes the PM2.5 samples: median of the latest samples followed by a moving average.
+ * Only integers are used; the average is kept with 4 fractional bits.
+ */
+class PM1006Filter
+{
+public:
+    PM1006Filter(int maximum);
+
+    bool add(int value);
+    /** @return filtered value or -1, if no sample was accepted yet */
+    int getFiltered() {
+        return (count_ > 0) ? ((average_ + 8) >> 4) : (-1);
+    }
+    int getRaw() {
+        return raw_;
+    }
+    uint16_t getWindowSamples() {
+        return window_samples_;
+    }
+    uint32_t getRejected() {
+        return rejected_;
+    }
+    void resetWindow() {
+        window_samples_ = 0;
+    }
+
+private:
+    int median_();
+
+    int maximum_;
+    uint16_t samples_[PM1006_FILTER_SAMPLES];
+    uint8_t next_ = 0;
+    uint8_t count_ = 0;
+    uint8_t jumps_ = 0;             /**< rejected jumps in a row */
+    int32_t average_ = 0;           /**< fixed point, 4 fractional bits */
+    int raw_ = -1;
+    uint16_t window_samples_ = 0;   /**< accepted since resetWindow() */
+    uint32_t rejected_ = 0;
+};
+
+#endif /* End of PM1006_RECEIVER */
@@ -0,0 +1,55 @@
+/**
+ * @file Scheduler.h
+ * @brief Cooperative scheduler: each task has its own period, phase and time budget
+ * @version 0.1
+ *
+ * At most one task is executed per loop, so the work of several tasks is spread over several loops.
+ * Tasks needing longer than their budget are reported as overrun.
+ */
+
+#ifndef SCHEDULER_COOPERATIVE
+#define SCHEDULER_COOPERATIVE
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define SCHEDULER_TASKS     8       /**< Maximum amount of tasks */
+
+typedef void (*scheduler_task)();
+typedef void (*scheduler_overrun)(const char *name, uint32_t duration, uint32_t budget);
+
+class Scheduler
+{
+public:
+    int add(const char *name, scheduler_task function, uint32_t period, uint32_t phase, uint32_t budget);
+    bool loop();
+
+    void onOverrun(scheduler_overrun handler) {
+        overrun_ = handler;
+    }
+    /** @return time (millis()), the task is executed next */
+    uint32_t getNextRun(int id) {
+        return tasks_[id].next;
+    }
+    uint32_t getOverruns() {
+        return overruns_;
+    }
+
+private:
+    struct Task {
+        const char *name;
+        scheduler_task function;
+        uint32_t period;        /**< ms between two executions */
+        uint32_t phase;         /**< ms after the start until the first execution */
+        uint32_t budget;        /**< ms, the task may need */
+        uint32_t next;
+    };
+
+    Task tasks_[SCHEDULER_TASKS];
+    uint8_t count_ = 0;
+    bool started_ = false;
+    uint32_t overruns_ = 0;
+    scheduler_overrun overrun_ = NULL;
+};
+
+#endif /* End of SCHEDULER_COOPERATIVE */
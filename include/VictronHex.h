@@ -0,0 +1,90 @@
+/**
+ * @file VictronHex.h
+ * @brief VE.Direct HEX protocol: pipelined register get and set
+ * @version 0.1
+ *
+ * Frames are ':' + command nibble + bytes in hex + checksum + '\n'.
+ * The sum of command, all bytes and the checksum is 0x55.
+ */
+
+#ifndef VICTRON_HEX
+#define VICTRON_HEX
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define VICTRON_HEX_FRAME_MAX   40      /**< Longest received hex frame without ':' and '\n' */
+#define VICTRON_HEX_QUEUE       8       /**< Requests, waiting or in flight */
+#define VICTRON_HEX_INFLIGHT    3       /**< Requests sent without having a response */
+#define VICTRON_HEX_TIMEOUT     500     /**< Milliseconds to wait for a response */
+#define VICTRON_HEX_RETRIES     3       /**< Retransmissions, before a request is dropped */
+
+#define VICTRON_HEX_CMD_GET     0x7
+#define VICTRON_HEX_CMD_SET     0x8
+#define VICTRON_HEX_CMD_ASYNC   0xA
+
+#define VICTRON_REG_LOAD_OUTPUT_CONTROL 0xEDAB  /**< un8: 0 off, 1 auto, 2 alt1, 3 alt2, 4 on */
+
+namespace victron
+{
+    /** Register value, received as answer of get/set or asynchronously */
+    struct VictronHexResponse {
+        uint8_t command;
+        uint16_t reg;
+        uint8_t flags;      /**< 0 on success */
+        uint32_t value;
+    };
+
+    class VictronHex
+    {
+    public:
+        VictronHex(Stream &port);
+
+        bool get(uint16_t reg);
+        bool set(uint16_t reg, uint32_t value, uint8_t size);
+        void loop(uint32_t now);
+        bool receive(const char *frame, uint8_t length, VictronHexResponse &response);
+
+        uint32_t getResponses() {
+            return responses_;
+        }
+
+        uint32_t getTimeouts() {
+            return timeouts_;
+        }
+
+        uint32_t getFailures() {
+            return failures_;
+        }
+
+        uint32_t getInvalidFrames() {
+            return invalid_frames_;
+        }
+
+    private:
+        enum { SLOT_FREE = 0, SLOT_QUEUED, SLOT_SENT };
+
+        struct Request {
+            uint8_t state = SLOT_FREE;
+            uint8_t command = 0;
+            uint16_t reg = 0;
+            uint32_t value = 0;
+            uint8_t size = 0;       /**< bytes of value, SET only */
+            uint8_t retries = 0;
+            uint32_t sent_at = 0;
+        };
+
+        bool enqueue_(uint8_t command, uint16_t reg, uint32_t value, uint8_t size);
+        void transmit_(Request &request, uint32_t now);
+
+        Stream &port_;
+        Request queue_[VICTRON_HEX_QUEUE];
+        uint32_t responses_ = 0;
+        uint32_t timeouts_ = 0;
+        uint32_t failures_ = 0;         /**< requests dropped after all retries */
+        uint32_t invalid_frames_ = 0;
+    };
+
+}  // namespace victron
+
+#endif /* End of VICTRON_HEX */
@@ -0,0 +1,65 @@
+/**
+ * @file VictronReplay.h
+ * @brief Replay of a recorded VE.Direct capture
+ * @version 0.1
+ *
+ * The capture (e.g. host/VictronDummyData.txt) is provided as byte source for the VictronComponent.
+ * Either with the timing of the real UART or as fast as possible.
+ * Only the Stream interface is used, so the replay runs on the device (SPIFFS file) and on the host.
+ */
+
+#ifndef VICTRON_REPLAY
+#define VICTRON_REPLAY
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#define VICTRON_REPLAY_MAXSPEED 0   /**< Bitrate to replay without any delay */
+
+namespace victron
+{
+
+    class VictronReplay : public Stream
+    {
+    public:
+        /**
+         * @param capture recorded bytes
+         * @param bitrate e.g. 19200 for real-time or VICTRON_REPLAY_MAXSPEED
+         */
+        VictronReplay(Stream &capture, uint32_t bitrate);
+
+        int available() override;
+        int read() override;
+        int peek() override;
+        /* Requests to the charger are dropped */
+        size_t write(uint8_t c) override;
+
+        uint32_t getBytes() {
+            return bytes_;
+        }
+
+        /**
+         * @brief Time from the first access of the parser until the last replayed byte, the base of the throughput
+         * @return milliseconds, 0 before the replay started; constant after the capture was replayed completely
+         */
+        uint32_t getDuration() {
+            if (start_ == 0) {
+                return 0;
+            }
+            return (finished_ ? end_ : millis()) - start_;
+        }
+
+    private:
+        uint32_t released_();
+
+        Stream &capture_;
+        uint32_t bitrate_;
+        uint32_t start_ = 0;
+        uint32_t end_ = 0;      /**< millis() of the last byte of the capture */
+        bool finished_ = false;
+        uint32_t bytes_ = 0;    /**< bytes already replayed */
+    };
+
+}  // namespace victron
+
+#endif /* End of VICTRON_REPLAY */
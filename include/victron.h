@@ -12,79 +12,337 @@
 #define VICTRON_MPPT
 
 #include <stdint.h>
-#include <Homie.h>
+#include <Arduino.h>
+#include "VictronHex.h"
 
 #define VICTRON_THROTTLE 100
 
-typedef void (*debug_serialcommunication) (std::string);
+#define VICTRON_LABEL_MAX       9   /**< Longest label of the text protocol, see VE.Direct specification */
+#define VICTRON_VALUE_MAX       33  /**< Longest value of the text protocol, see VE.Direct specification */
+#define VICTRON_LINE_MAX        64  /**< Raw line buffer used for debugging, longer lines are cut */
+#define VICTRON_DEBUG_BUFFER    512 /**< Raw lines, collected for one debug message */
+#define VICTRON_DEBUG_BATCH     384 /**< Send the collected lines, if this amount of bytes is reached */
+#define VICTRON_DEBUG_INTERVAL  5000 /**< Send the collected lines at least after this amount of milliseconds */
+#define VICTRON_BYTES_PER_LOOP  64  /**< Maximum amount of bytes, parsed with one call of loop() */
+#define VICTRON_JSON_MAX        640 /**< Buffer for the JSON document of all values */
+#define VICTRON_SAMPLE_GAP      5000 /**< Longest time in milliseconds, a value is integrated without new frame */
+
+typedef bool (*debug_serialcommunication) (const char *);  /**< false, if the lines were not logged completely */
 
 namespace victron
 {
+    constexpr uint32_t label_hash_step(uint32_t hash, uint8_t c)
+    {
+        return (hash ^ c) * 16777619UL;
+    }
+
+    /**
+     * @brief FNV-1a hash of a label, usable at compile time
+     */
+    constexpr uint32_t label_hash(const char *label, uint32_t hash = 2166136261UL)
+    {
+        return (*label == '\0') ? hash : label_hash(label + 1, label_hash_step(hash, *label));
+    }
+
+    /** Values of the text protocol, stored by the component */
+    enum VictronField {
+        FIELD_SKIP = 0,
+        FIELD_BATTERY_VOLTAGE,
+        FIELD_PANEL_VOLTAGE,
+        FIELD_PANEL_POWER,
+        FIELD_BATTERY_CURRENT,
+        FIELD_LOAD_CURRENT,
+        FIELD_LOAD_STATE,
+        FIELD_YIELD_TOTAL,
+        FIELD_YIELD_TODAY,
+        FIELD_MAX_POWER_TODAY,
+        FIELD_YIELD_YESTERDAY,
+        FIELD_MAX_POWER_YESTERDAY,
+        FIELD_ERROR_CODE,
+        FIELD_CHARGING_MODE,
+        FIELD_DEVICE_TYPE,
+        FIELD_DAY_NUMBER,
+        FIELD_TRACKING_MODE
+    };
+
+    /** Interpretation of the value */
+    enum VictronParse {
+        PARSE_SKIP = 0,
+        PARSE_INT,      /**< decimal number */
+        PARSE_YIELD,    /**< decimal number in 0.01 kWh, stored in Wh */
+        PARSE_HEX,      /**< number with 0x prefix */
+        PARSE_ONOFF     /**< "ON" or "OFF" */
+    };
+
+    /** Entry of the label table */
+    struct VictronLabel {
+        const char *label;
+        uint8_t field;      /**< VictronField */
+        uint8_t parse;      /**< VictronParse */
+    };
+
+    bool find_label(uint32_t hash, const char *label, VictronLabel &entry);
+
+    /** All values of one frame */
+    struct VictronData {
+        int max_power_yesterday_sensor_ = 0;
+        int max_power_today_sensor_ = 0;
+        long yield_total_sensor_ = 0;       /**< Wh */
+        long yield_yesterday_sensor_ = 0;   /**< Wh */
+        long yield_today_sensor_ = 0;       /**< Wh */
+        int panel_voltage_sensor_ = 0;
+        int panel_power_sensor_ = 0;
+        int battery_voltage_sensor_ = 0;
+        int battery_current_sensor_ = 0;
+        int load_current_sensor_ = 0;
+        int day_number_sensor_ = 0;
+        int charging_mode_id_sensor_ = 0;
+        int error_code_sensor_ = 0;
+        int tracking_mode_id_sensor_ = 0;
+
+        bool load_state_binary_sensor_ = false;
+
+        long device_type_text_sensor_ = 0;
+    };
+
+    /** Minimum, maximum and mean of one value, with constant memory */
+    struct VictronStatistic {
+        int32_t min = 0;
+        int32_t max = 0;
+        int64_t sum = 0;
+        uint32_t count = 0;
+
+        void add(int32_t value) {
+            if ((count == 0) || (value < min)) {
+                min = value;
+            }
+            if ((count == 0) || (value > max)) {
+                max = value;
+            }
+            sum += value;
+            count++;
+        }
+
+        int32_t mean() const {
+            return (count > 0) ? (int32_t) (sum / count) : 0;
+        }
+    };
+
+    /** All frames received between two publish cycles */
+    struct VictronWindow {
+        VictronStatistic battery_voltage;   /**< mV */
+        VictronStatistic battery_current;   /**< mA */
+        VictronStatistic panel_power;       /**< W */
+        int64_t battery_energy = 0;         /**< V * I integrated in uW * ms */
+        int64_t panel_energy = 0;           /**< PPV integrated in W * ms */
+        uint32_t frames = 0;
+
+        /** Energy in mWh */
+        int32_t batteryEnergy() const {
+            return (int32_t) (battery_energy / 3600000000LL);
+        }
+
+        /** Energy in mWh */
+        int32_t panelEnergy() const {
+            return (int32_t) (panel_energy / 3600LL);
+        }
+    };
 
     class VictronComponent 
     {
     public:
         VictronComponent(int initialstate);
-        VictronComponent();
+        /**
+         * @brief Parse the VE.Direct protocol of any source
+         * @param source e.g. a UART, SoftwareSerial or the replay of a capture
+         */
+        VictronComponent(Stream &source, int initialstate = 0);
         ~VictronComponent();
         void loop(void);
-        String toJson(void);
+
+        /**
+         * @brief Write all values as JSON document into the given buffer
+         * @return length of the document, 0 if the buffer is too small
+         */
+        size_t toJson(char *buffer, size_t size);
 
         int getBatteryVoltage() {
-            return (battery_voltage_sensor_ / 1000);
+            return (data_.battery_voltage_sensor_ / 1000);
         }
 
         int getPanelVoltage() {
-            return (panel_voltage_sensor_ / 1000);
+            return (data_.panel_voltage_sensor_ / 1000);
+        }
+
+        /** Battery voltage in mV */
+        int getBatteryMillivolt() {
+            return data_.battery_voltage_sensor_;
+        }
+
+        /** Panel voltage in mV */
+        int getPanelMillivolt() {
+            return data_.panel_voltage_sensor_;
         }
 
         int getPanelPower() {
-            return panel_power_sensor_;
+            return data_.panel_power_sensor_;
+        }
+
+        /** Yield today in Wh */
+        long getYieldToday() {
+            return data_.yield_today_sensor_;
+        }
+
+        /** Yield total in Wh */
+        long getYieldTotal() {
+            return data_.yield_total_sensor_;
         }
 
         bool hasData() {
-            return (battery_voltage_sensor_ > 0);
+            return (data_.battery_voltage_sensor_ > 0);
+        }
+
+        uint32_t getGoodFrames() {
+            return good_frames_;
+        }
+
+        uint32_t getBadFrames() {
+            return bad_frames_;
+        }
+
+        uint32_t getTruncatedFrames() {
+            return truncated_frames_;
+        }
+
+        uint32_t getBytesReceived() {
+            return bytes_received_;
+        }
+
+        uint32_t getOverlongFields() {
+            return overlong_fields_;
+        }
+
+        uint32_t getUnknownLabels() {
+            return unknown_labels_;
+        }
+
+        /**
+         * @brief Read a register with the VE.Direct HEX protocol
+         * The answer is received asynchronously by loop()
+         */
+        bool requestRegister(uint16_t reg) {
+            return hex_.get(reg);
+        }
+
+        /**
+         * @brief Control the load output
+         * @param mode 0 off, 1 auto, 2 alt1, 3 alt2, 4 on
+         */
+        bool setLoadOutput(uint8_t mode) {
+            return hex_.set(VICTRON_REG_LOAD_OUTPUT_CONTROL, mode, 1);
+        }
+
+        /**
+         * @brief Load output control, reported by the charger
+         * @return -1 if still unknown
+         */
+        int getLoadOutputControl() {
+            return load_output_control_;
+        }
+
+        /**
+         * @brief Statistic of all frames since the last call of resetWindow()
+         */
+        const VictronWindow &getWindow() {
+            return window_;
+        }
+
+        void resetWindow() {
+            window_ = VictronWindow();
         }
 
+        VictronHex &getHex() {
+            return hex_;
+        }
+
+        /**
+         * @brief Forward the raw received lines
+         * Several lines are collected and passed at once, separated by a newline.
+         * @param debugFunction NULL deactivates debugging
+         */
         void activateDebugging(debug_serialcommunication debugFunction);
 
+        bool isDebugging() {
+            return (fdebugSerial != NULL);
+        }
+
+        /** Amount of raw lines, which were not logged completely (debug buffer or log queue full, message cut) */
+        uint32_t getDebugDropped() {
+            return debug_dropped_;
+        }
+
     private:
         void handle_value_();
+        void store_(uint8_t field, long value);
+        void end_frame_(uint32_t now);
+        void discard_frame_();
+        void handle_hex_();
+        void aggregate_(uint32_t now);
         void logTextSensor(String tag, String message, std::string text);
         void logBinarySensor(String tag, String message, bool flag);
         void logSensor(String tag, String message, int number);
 
+        void append_(char *buffer, uint8_t &length, uint8_t maximum, uint8_t c);
+        void debug_line_(uint32_t now);
+        void debug_flush_();
+
+        Stream &source_;
+        uint32_t bytes_received_ = 0;
+
         /* States during serial parsing */
-        bool publishing_;
-        int state_;
-        std::string label_;
-        std::string value_;
-        std::string complete_line_;
-        uint32_t last_transmission_;
-        uint32_t last_publish_;
+        bool publishing_ = false;
+        int state_ = 0;
+        char label_[VICTRON_LABEL_MAX + 1];
+        uint8_t label_length_ = 0;
+        uint32_t label_hash_ = 0;       /**< calculated while receiving the label */
+        char value_[VICTRON_VALUE_MAX + 1];
+        uint8_t value_length_ = 0;
+        bool overlong_ = false;         /**< label or value of the actual line did not fit into its buffer */
+        uint32_t overlong_fields_ = 0;  /**< Amount of dropped lines, as label or value were too long */
+        uint32_t unknown_labels_ = 0;   /**< Amount of received lines with an unknown label */
+        char complete_line_[VICTRON_LINE_MAX + 1];
+        uint8_t complete_line_length_ = 0;
+        char debug_batch_[VICTRON_DEBUG_BUFFER];
+        uint16_t debug_length_ = 0;
+        uint8_t debug_lines_ = 0;       /**< lines in debug_batch_ */
+        uint32_t debug_first_ = 0;      /**< millis() of the oldest collected line */
+        uint32_t debug_dropped_ = 0;
+        uint32_t last_transmission_ = 0;
+        uint32_t last_publish_ = 0;
 
         debug_serialcommunication fdebugSerial = NULL;
 
-        /* All Settings */
-        int max_power_yesterday_sensor_ = 0;
-        int max_power_today_sensor_ = 0;
-        float yield_total_sensor_ = 0;
-        float yield_yesterday_sensor_ = 0;
-        float yield_today_sensor_ = 0;
-        int panel_voltage_sensor_ = 0;
-        int panel_power_sensor_ = 0;
-        int battery_voltage_sensor_ = 0;
-        int battery_current_sensor_ = 0;
-        int load_current_sensor_ = 0;
-        int day_number_sensor_ = 0;
-        int charging_mode_id_sensor_ = 0;
-        int error_code_sensor_ = 0;
-        int tracking_mode_id_sensor_ = 0;
+        /* Checksum validation of the text protocol */
+        uint8_t checksum_ = 0;          /**< sum of all bytes of the actual frame */
+        bool frame_started_ = false;    /**< bytes of a new frame were received */
+        bool frame_overlong_ = false;   /**< a field of the actual frame was dropped */
+        uint32_t good_frames_ = 0;
+        uint32_t bad_frames_ = 0;
+        uint32_t truncated_frames_ = 0;
 
+        /* VE.Direct HEX protocol */
+        VictronHex hex_;
+        char hex_frame_[VICTRON_HEX_FRAME_MAX + 1];
+        uint8_t hex_length_ = 0;
+        int load_output_control_ = -1;
 
-        bool load_state_binary_sensor_;
+        /* Aggregation between two publish cycles */
+        VictronWindow window_;
+        uint32_t frame_fields_ = 0;     /**< Bit per VictronField, received in the actual frame */
+        uint32_t last_sample_ = 0;      /**< millis() of the last aggregated frame */
 
-        long device_type_text_sensor_;
+        VictronData staging_;   /**< filled while receiving a frame */
+        VictronData data_;      /**< last frame with a valid checksum */
     };
 
 }  // namespace victron
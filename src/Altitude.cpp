@@ -0,0 +1,55 @@
+/**
+ * @file Altitude.cpp
+ * @brief Altitude of the measured pressure, without pow()
+ * @version 0.1
+ *
+ */
+
+#include <Arduino.h>
+#include "Altitude.h"
+
+/** Altitude (cm) for each ALTITUDE_PRESSURE_STEP from ALTITUDE_PRESSURE_MIN to ALTITUDE_PRESSURE_MAX */
+static const int32_t kAltitudeTable[] PROGMEM = {
+    916537, 894526, 873083, 852175, 831775, 811854, 792389, 773358,
+    754738, 736511, 718658, 701163, 684011, 667186, 650674, 634464,
+    618543, 602900, 587524, 572406, 557535, 542903, 528501, 514322,
+    500358, 486602, 473047, 459686, 446514, 433525, 420713, 408072,
+    395598, 383286, 371131, 359129, 347276, 335567, 323998, 312567,
+    301269, 290101, 279060, 268142, 257345, 246665, 236099, 225646,
+    215302, 205065, 194932, 184902, 174971, 165137, 155400, 145755,
+    136202, 126739, 117363, 108073, 98867, 89744, 80701, 71738,
+    62853, 54043, 45309, 36647, 28058, 19540, 11090, 2709,
+    -5605, -13853, -22037, -30157, -38215, -46212, -54148, -62025,
+    -69844,
+};
+static_assert(SEALEVELPRESSURE_HPA == 1013.25, "kAltitudeTable needs to be calculated for the new sea level pressure");
+static_assert((sizeof(kAltitudeTable) / sizeof(kAltitudeTable[0])) ==
+              ((ALTITUDE_PRESSURE_MAX - ALTITUDE_PRESSURE_MIN) / ALTITUDE_PRESSURE_STEP + 1),
+              "kAltitudeTable needs one entry for each step");
+
+/**
+ * @brief Altitude without pow(): linear interpolation of kAltitudeTable (error below 1 m)
+ * Pressures outside of the table are limited to its first or last entry.
+ * @param pressure in Pa
+ * @return altitude in cm
+ */
+int32_t altitudeFromPressure(int32_t pressure)
+{
+    const int32_t last = (sizeof(kAltitudeTable) / sizeof(kAltitudeTable[0])) - 1;
+    int32_t index;
+    int32_t offset;
+    int32_t lower;
+    int32_t upper;
+
+    if (pressure <= ALTITUDE_PRESSURE_MIN) {
+        return (int32_t) pgm_read_dword(&kAltitudeTable[0]);
+    }
+    index = (pressure - ALTITUDE_PRESSURE_MIN) / ALTITUDE_PRESSURE_STEP;
+    if (index >= last) {
+        return (int32_t) pgm_read_dword(&kAltitudeTable[last]);
+    }
+    offset = (pressure - ALTITUDE_PRESSURE_MIN) % ALTITUDE_PRESSURE_STEP;
+    lower = (int32_t) pgm_read_dword(&kAltitudeTable[index]);
+    upper = (int32_t) pgm_read_dword(&kAltitudeTable[index + 1]);
+    return lower + ((upper - lower) * offset) / ALTITUDE_PRESSURE_STEP;
+}
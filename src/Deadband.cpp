@@ -0,0 +1,60 @@
+/**
+ * @file Deadband.cpp
+ * @brief Decides, if a property needs to be published again
+ * @version 0.1
+ *
+ */
+
+#include "Deadband.h"
+
+uint32_t Deadband::heartbeat_ = DEADBAND_HEARTBEAT_DEFAULT;
+uint32_t Deadband::sent_ = 0;
+uint32_t Deadband::suppressed_ = 0;
+
+bool Deadband::due_(bool changed)
+{
+    const uint32_t now = millis();
+
+    if (valid_ && !changed && ((now - sent_at_) < heartbeat_)) {
+        suppressed_++;
+        return false;
+    }
+    valid_ = true;
+    sent_at_ = now;
+    sent_++;
+    return true;
+}
+
+/**
+ * @brief Check a number
+ * @return true, if the value must be published
+ */
+bool Deadband::check(long value)
+{
+    long difference = value - last_;
+    bool changed = (difference > width_) || (difference < -width_);
+
+    if (due_(changed)) {
+        last_ = value;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Check a text (e.g. JSON), each change is published
+ * @return true, if the text must be published
+ */
+bool Deadband::check(const char *text)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261UL;
+    while (*text) {
+        hash = (hash ^ (uint8_t) *text++) * 16777619UL;
+    }
+    if (due_(hash != last_hash_)) {
+        last_hash_ = hash;
+        return true;
+    }
+    return false;
+}
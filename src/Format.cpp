@@ -0,0 +1,104 @@
+/**
+ * @file Format.cpp
+ * @brief Numbers as text into a buffer of the caller, without String and dtostrf()
+ * @version 0.1
+ *
+ */
+
+#include "Format.h"
+
+static const char kDigits[] = "0123456789abcdef";
+static const long kScale[FORMAT_DECIMALS_MAX + 1] = { 1L, 10L, 100L, 1000L, 10000L, 100000L, 1000000L };
+
+/**
+ * @brief Scaled integer as decimal text
+ * @param buffer at least FORMAT_NUMBER_MAX characters
+ * @param value  e.g. 2153
+ * @param decimals e.g. 2 for "21.53"
+ * @return buffer
+ */
+char *formatNumber(char *buffer, long value, uint8_t decimals)
+{
+    char digits[12];
+    uint8_t count = 0;
+    uint8_t length = 0;
+    unsigned long magnitude = (value < 0) ? (0UL - (unsigned long) value) : (unsigned long) value;
+
+    if (value < 0) {
+        buffer[length++] = '-';
+    }
+    /* at least one digit in front of the decimal point */
+    do {
+        digits[count++] = kDigits[magnitude % 10];
+        magnitude /= 10;
+    } while ((magnitude > 0 || count <= decimals) && (count < sizeof(digits)));
+    while (count > 0) {
+        if (count == decimals) {
+            buffer[length++] = '.';
+        }
+        buffer[length++] = digits[--count];
+    }
+    buffer[length] = '\0';
+    return buffer;
+}
+
+/**
+ * @brief Unsigned integer as text, e.g. counters or status bits in hex
+ * @param buffer at least FORMAT_NUMBER_MAX characters
+ * @param base 2 to 16; only the lowest FORMAT_NUMBER_MAX - 1 digits are written (large values in base 2 or 3)
+ * @return buffer
+ */
+char *formatUnsigned(char *buffer, unsigned long value, uint8_t base)
+{
+    char digits[FORMAT_NUMBER_MAX];
+    uint8_t count = 0;
+    uint8_t length = 0;
+
+    if ((base < 2) || (base > 16)) {
+        base = 10;
+    }
+    do {
+        digits[count++] = kDigits[value % base];
+        value /= base;
+    } while ((value > 0) && (count < (sizeof(digits) - 1)));
+    while (count > 0) {
+        buffer[length++] = digits[--count];
+    }
+    buffer[length] = '\0';
+    return buffer;
+}
+
+/**
+ * @brief Scaled integer rounded to less decimals (or extended by zeros), e.g. Pa as hPa with one decimal
+ * @param buffer at least FORMAT_NUMBER_MAX characters
+ * @param value  e.g. 101325
+ * @param scale  decimals of the value, e.g. 2 for Pa as hPa
+ * @param decimals e.g. 1 for "1013.3"
+ * @return buffer
+ */
+char *formatScaled(char *buffer, long value, uint8_t scale, uint8_t decimals)
+{
+    long divisor;
+
+    if (scale > FORMAT_DECIMALS_MAX) {
+        scale = FORMAT_DECIMALS_MAX;
+    }
+    if (decimals > FORMAT_DECIMALS_MAX) {
+        decimals = FORMAT_DECIMALS_MAX;
+    }
+    if (decimals >= scale) {
+        /* only zeros are appended; values out of range are shown without them */
+        if ((value > (2147483647L / kScale[decimals - scale])) || (value < (-2147483647L / kScale[decimals - scale]))) {
+            return formatNumber(buffer, value, scale);
+        }
+        return formatNumber(buffer, value * kScale[decimals - scale], decimals);
+    }
+    /* round half away from zero */
+    divisor = kScale[scale - decimals];
+    if (value < 0) {
+        value = -((divisor / 2 - value) / divisor);
+    } else {
+        value = (value + divisor / 2) / divisor;
+    }
+    return formatNumber(buffer, value, decimals);
+}
@@ -0,0 +1,91 @@
+/**
+ * @file IaqBaseline.cpp
+ * @brief Air quality index from the gas resistance and humidity of the BME680
+ * @version 0.1
+ *
+ */
+
+#ifdef BME680
+#include "IaqBaseline.h"
+#include <FS.h>
+
+#define IAQ_MAGIC       0x49415131      /**< "IAQ1" */
+
+void IaqBaseline::begin()
+{
+    State stored;
+
+    if (ESP.rtcUserMemoryRead(IAQ_RTC_OFFSET, (uint32_t *) &stored, sizeof(stored)) && (stored.magic == IAQ_MAGIC)) {
+        state_ = stored;
+        return;
+    }
+    /* after a power loss */
+    File file = SPIFFS.open(IAQ_FILE, "r");
+    if (file) {
+        if ((file.read((uint8_t *) &stored, sizeof(stored)) == sizeof(stored)) && (stored.magic == IAQ_MAGIC)) {
+            state_ = stored;
+        }
+        file.close();
+    }
+    state_.magic = IAQ_MAGIC;
+}
+
+void IaqBaseline::store_()
+{
+    ESP.rtcUserMemoryWrite(IAQ_RTC_OFFSET, (uint32_t *) &state_, sizeof(state_));
+    if ((state_.samples % IAQ_SAVE_SAMPLES) == 0) {
+        File file = SPIFFS.open(IAQ_FILE, "w");
+        if (file) {
+            file.write((const uint8_t *) &state_, sizeof(state_));
+            file.close();
+        }
+    }
+}
+
+/**
+ * @brief Update the baseline with a new measurement
+ * 
+ * @param gas resistance in Ohm
+ * @param humidity relative humidity in 0.01 %
+ * @return int index (0 excellent, 500 worst) or -1 during the burn-in
+ */
+int IaqBaseline::update(uint32_t gas, int32_t humidity)
+{
+    int humidityOffset = ((int) (humidity / 10)) - IAQ_HUMIDITY_BASELINE;
+    int humidityScore;
+    int gasScore;
+
+    if (gas == 0) {
+        return (-1);
+    }
+    if (state_.baseline == 0) {
+        state_.baseline = gas;
+    } else if (gas > state_.baseline) {
+        state_.baseline += (gas - state_.baseline) >> IAQ_RISE_SHIFT;
+    } else {
+        state_.baseline -= (state_.baseline - gas) >> IAQ_FALL_SHIFT;
+    }
+    state_.samples++;
+    store_();
+    if (state_.samples < IAQ_BURN_IN) {
+        return (-1);
+    }
+
+    /* humidity: best at the baseline, worst at 0 and 100% */
+    if (humidityOffset > 0) {
+        humidityScore = ((1000 - IAQ_HUMIDITY_BASELINE - humidityOffset) * IAQ_HUMIDITY_WEIGHT) / (1000 - IAQ_HUMIDITY_BASELINE);
+    } else {
+        humidityScore = ((IAQ_HUMIDITY_BASELINE + humidityOffset) * IAQ_HUMIDITY_WEIGHT) / IAQ_HUMIDITY_BASELINE;
+    }
+    if (humidityScore < 0) {
+        humidityScore = 0;
+    }
+    /* gas: the lower the resistance below the baseline, the more volatile organic compounds */
+    if (gas < state_.baseline) {
+        gasScore = (int) (((uint64_t) gas * (100 - IAQ_HUMIDITY_WEIGHT)) / state_.baseline);
+    } else {
+        gasScore = 100 - IAQ_HUMIDITY_WEIGHT;
+    }
+    return (100 - humidityScore - gasScore) * 5;
+}
+#endif /* BME680 */
@@ -0,0 +1,157 @@
+/**
+ * @file JsonWriter.cpp
+ * @brief Streaming JSON serializer into a fixed buffer
+ * @version 0.1
+ *
+ */
+
+#include "JsonWriter.h"
+#include "Format.h"
+
+JsonWriter::JsonWriter(char *buffer, size_t size) : buffer_(buffer), size_(size)
+{
+    if (size_ > 0) {
+        buffer_[0] = '\0';
+    } else {
+        overflow_ = true;
+    }
+}
+
+void JsonWriter::char_(char c)
+{
+    /* one byte is always kept for the terminating zero */
+    if (length_ + 1 < size_) {
+        buffer_[length_++] = c;
+        buffer_[length_] = '\0';
+    } else {
+        overflow_ = true;
+    }
+}
+
+void JsonWriter::raw_(const char *text)
+{
+    while (*text) {
+        char_(*text++);
+    }
+}
+
+void JsonWriter::escaped_(char c)
+{
+    static const char kHex[] = "0123456789abcdef";
+    switch (c) {
+        case '"':
+        case '\\':
+        char_('\\');
+        char_(c);
+        break;
+        case '\n':
+        raw_("\\n");
+        break;
+        case '\r':
+        raw_("\\r");
+        break;
+        case '\t':
+        raw_("\\t");
+        break;
+        default:
+        if ((uint8_t) c < 0x20) {
+            raw_("\\u00");
+            char_(kHex[(c >> 4) & 0x0F]);
+            char_(kHex[c & 0x0F]);
+        } else {
+            char_(c);
+        }
+        break;
+    }
+}
+
+void JsonWriter::key_(const char *key)
+{
+    if (comma_) {
+        char_(',');
+    }
+    comma_ = true;
+    if (key) {
+        char_('"');
+        while (*key) {
+            escaped_(*key++);
+        }
+        raw_("\":");
+    }
+}
+
+void JsonWriter::number_(long value, uint8_t decimals)
+{
+    char number[FORMAT_NUMBER_MAX];
+    raw_(formatNumber(number, value, decimals));
+}
+
+void JsonWriter::beginObject(const char *key)
+{
+    key_(key);
+    char_('{');
+    comma_ = false;
+}
+
+void JsonWriter::endObject()
+{
+    char_('}');
+    comma_ = true;
+}
+
+void JsonWriter::beginArray(const char *key)
+{
+    key_(key);
+    char_('[');
+    comma_ = false;
+}
+
+void JsonWriter::endArray()
+{
+    char_(']');
+    comma_ = true;
+}
+
+void JsonWriter::add(const char *key, long value)
+{
+    key_(key);
+    number_(value, 0);
+}
+
+void JsonWriter::addFixed(const char *key, long value, uint8_t decimals)
+{
+    key_(key);
+    number_(value, decimals);
+}
+
+void JsonWriter::add(const char *key, const char *text)
+{
+    key_(key);
+    char_('"');
+    while (*text) {
+        escaped_(*text++);
+    }
+    char_('"');
+}
+
+void JsonWriter::addP(const char *key, PGM_P text)
+{
+    char c;
+    key_(key);
+    char_('"');
+    while ((c = pgm_read_byte(text++)) != '\0') {
+        escaped_(c);
+    }
+    char_('"');
+}
+
+void JsonWriter::rewind(size_t mark)
+{
+    if (mark >= size_) {
+        return;
+    }
+    length_ = mark;
+    buffer_[length_] = '\0';
+    overflow_ = false;
+    comma_ = (length_ > 0) && (buffer_[length_ - 1] != '[') && (buffer_[length_ - 1] != '{');
+}
@@ -6,33 +6,381 @@
  *
  */
 
+#include <Homie.h>
 #include "MqttLog.h"
+#include "JsonWriter.h"
 
 bool mConnected = false;
+long mLogLevel = MQTT_LOG_LEVEL;
 
-#define getTopic(test, topic)                                                                                                                 \
-  char *topic = new char[strlen(Homie.getConfiguration().mqtt.baseTopic) + strlen(Homie.getConfiguration().deviceId) + 1 + strlen(test) + 1]; \
-  strcpy(topic, Homie.getConfiguration().mqtt.baseTopic);                                                                                     \
-  strcat(topic, Homie.getConfiguration().deviceId);                                                                                           \
-  strcat(topic, "/");                                                                                                                         \
-  strcat(topic, test);         
+#define LOG_FLAG_PREVIOUS_BOOT  0x01    /**< Record was stored in RTC memory before the last reset */
 
+/** Queued record, followed by the message and its terminating zero */
+struct LogRecord {
+  uint32_t uptime;
+  int statusCode;
+  uint16_t length;
+  uint8_t level;
+  uint8_t flags;
+};
 
-void log(int level, String message, int statusCode)
+#ifdef MQTT_LOG_RTC
+/** Record in RTC user memory: the beginning of the message only */
+struct RtcLogRecord {
+  uint32_t uptime;
+  int16_t statusCode;
+  uint8_t level;
+  uint8_t length;
+  char message[MQTT_LOG_RTC_MESSAGE];
+};
+
+struct RtcLogHeader {
+  uint32_t magic;
+  uint16_t next;        /**< record to be written next */
+  uint16_t count;
+};
+
+#define RTC_LOG_MAGIC           0x4C4F4731      /**< "LOG1" */
+#define RTC_LOG_BLOCK(index)    (MQTT_LOG_RTC_OFFSET + ((sizeof(RtcLogHeader) + ((index) * sizeof(RtcLogRecord))) / 4))
+
+static_assert((sizeof(RtcLogRecord) % 4) == 0, "RTC memory is accessed in blocks of 4 bytes");
+static_assert(RTC_LOG_BLOCK(MQTT_LOG_RTC_RECORDS) <= MQTT_LOG_RTC_END, "RTC log exceeds its area");
+
+static RtcLogHeader mRtcHeader = { RTC_LOG_MAGIC, 0, 0 };
+#endif
+
+/** Token bucket of one message (status code and hash of the text) */
+struct LogLimit {
+  uint32_t hash;
+  int statusCode;
+  uint32_t refilled;            /**< time of the last token refill */
+  uint32_t suppressedSince;
+  uint32_t lastUse;
+  uint16_t suppressed;          /**< repeats, not logged yet */
+  uint8_t tokens;
+  uint8_t level;
+  char text[MQTT_LOG_LIMIT_TEXT + 1];
+};
+
+static LogLimit mLogLimits[MQTT_LOG_LIMIT_SLOTS];
+static uint32_t mLogSuppressed = 0;
+
+static uint8_t mLogQueue[MQTT_LOG_QUEUE_SIZE];
+static size_t mLogQueueUsed = 0;
+static char mLogTopic[MQTT_LOG_TOPIC_MAX] = "";
+static uint32_t mLogLastFlush = 0;
+static uint32_t mLogDropped = 0;        /**< all records, lost as the queue was full */
+static uint32_t mLogDroppedReported = 0;
+static uint32_t mLogBatches = 0;
+
+static uint8_t qosOfLevel(int level)
+{
+  if (level <= MQTT_LEVEL_ERROR) {
+    return MQTT_LOG_QOS_ERROR;
+  } else if (level <= MQTT_LEVEL_WARNING) {
+    return MQTT_LOG_QOS_WARNING;
+  } else if (level <= MQTT_LEVEL_INFO) {
+    return MQTT_LOG_QOS_INFO;
+  }
+  return MQTT_LOG_QOS_DEBUG;
+}
+
+/**
+ * @return false, if the record was dropped or cut
+ */
+static bool enqueue(int level, const char *message, int statusCode, uint32_t uptime, uint8_t flags)
+{
+  LogRecord record;
+  size_t length = strlen(message);
+  bool complete = true;
+
+  /* a single record must always fit into one batch */
+  if (length > MQTT_LOG_MESSAGE_MAX) {
+    length = MQTT_LOG_MESSAGE_MAX;
+    complete = false;
+  }
+  if (mLogQueueUsed + sizeof(record) + length + 1 > sizeof(mLogQueue)) {
+    mLogDropped++;
+    return false;
+  }
+  record.uptime = uptime;
+  record.statusCode = statusCode;
+  record.length = length;
+  record.level = level;
+  record.flags = flags;
+  memcpy(mLogQueue + mLogQueueUsed, &record, sizeof(record));
+  mLogQueueUsed += sizeof(record);
+  memcpy(mLogQueue + mLogQueueUsed, message, length);
+  mLogQueueUsed += length;
+  mLogQueue[mLogQueueUsed++] = '\0';
+  return complete;
+}
+
+static void addRecord(JsonWriter &json, const LogRecord &record, const char *message)
+{
+  json.beginObject();
+  json.add("level", (long) record.level);
+  json.add("uptime", (long) record.uptime);
+  json.add("message", message);
+  json.add("statusCode", (long) record.statusCode);
+  if (record.flags & LOG_FLAG_PREVIOUS_BOOT) {
+    json.add("previousBoot", 1L);
+  }
+  json.endObject();
+}
+
+void logFlush()
 {
-  String buffer;
-  StaticJsonDocument<200> doc;
-  doc["level"] = level;
-  doc["uptime"] = String(millis());
-  doc["message"] = message;
-  doc["statusCode"] = statusCode;
-  serializeJson(doc, buffer);
-  if (mConnected)
-  {
-    getTopic(LOG_TOPIC, logTopic)
+  static char batch[MQTT_LOG_BATCH_SIZE];
+  JsonWriter json(batch, sizeof(batch));
+  size_t position = 0;
+  uint8_t qos = 0;
+  uint32_t dropped = mLogDropped - mLogDroppedReported;
+
+  mLogLastFlush = millis();
+  if (!mConnected || ((mLogQueueUsed == 0) && (dropped == 0))) {
+    return;
+  }
+  if (mLogTopic[0] == '\0') {
+    snprintf(mLogTopic, sizeof(mLogTopic), "%s%s/%s", Homie.getConfiguration().mqtt.baseTopic,
+             Homie.getConfiguration().deviceId, LOG_TOPIC);
+  }
+
+  json.beginArray();
+  if (dropped > 0) {
+    char message[40];
+    LogRecord record = { mLogLastFlush, MQTT_LOG_LOGGER, 0, MQTT_LEVEL_WARNING, 0 };
+    snprintf(message, sizeof(message), "%u log messages dropped", (unsigned int) dropped);
+    addRecord(json, record, message);
+    qos = qosOfLevel(MQTT_LEVEL_WARNING);
+  }
+  /* As many records as fit into one publish, the rest stays queued */
+  while (position < mLogQueueUsed) {
+    LogRecord record;
+    size_t mark = json.mark();
+    memcpy(&record, mLogQueue + position, sizeof(record));
+    addRecord(json, record, (const char *) (mLogQueue + position + sizeof(record)));
+    if (json.overflow() || (json.length() + 2 > sizeof(batch))) {
+      json.rewind(mark);
+      break;
+    }
+    if (qosOfLevel(record.level) > qos) {
+      qos = qosOfLevel(record.level);
+    }
+    position += sizeof(record) + record.length + 1;
+  }
+  json.endArray();
+
+  if ((position == 0) && (dropped == 0)) {
+    /* too many characters to escape: the record never fits */
+    LogRecord record;
+    memcpy(&record, mLogQueue, sizeof(record));
+    position = sizeof(record) + record.length + 1;
+    mLogDropped++;
+  } else if (Homie.getMqttClient().publish(mLogTopic, qos, false, batch) == 0) {
+    /* send buffer of the client is full: try again with the next flush */
+    return;
+  } else {
+    mLogDroppedReported += dropped;
+    mLogBatches++;
+  }
+  memmove(mLogQueue, mLogQueue + position, mLogQueueUsed - position);
+  mLogQueueUsed -= position;
+}
 
-    Homie.getMqttClient().publish(logTopic, 2, false, buffer.c_str());
-    delete logTopic;
+static uint32_t messageHash(const char *message)
+{
+  /* FNV-1a */
+  uint32_t hash = 2166136261UL;
+  while (*message) {
+    hash = (hash ^ (uint8_t) *message++) * 16777619UL;
   }
+  return hash;
+}
+
+static bool output(int level, const char *message, int statusCode);
+
+/** Log, how often a message was suppressed */
+static void reportSuppressed(LogLimit &limit, uint32_t now)
+{
+  char message[MQTT_LOG_LIMIT_TEXT + 32];
+
+  if (limit.suppressed == 0) {
+    return;
+  }
+  snprintf(message, sizeof(message), "repeated %u times: %s", (unsigned int) limit.suppressed, limit.text);
+  limit.suppressed = 0;
+  limit.suppressedSince = now;
+  output(limit.level, message, limit.statusCode);
+}
+
+/**
+ * @brief Token bucket per message: a few repeats are logged at once, afterwards one per interval.
+ * The suppressed repeats are collapsed into one record per interval.
+ * @return true, if the message is logged
+ */
+static bool rateLimit(int level, const char *message, int statusCode)
+{
+  const uint32_t now = millis();
+  const uint32_t hash = messageHash(message);
+  LogLimit *limit = NULL;
+  LogLimit *oldest = &mLogLimits[0];
+
+  for (LogLimit &candidate : mLogLimits) {
+    if ((candidate.lastUse != 0) && (candidate.hash == hash) && (candidate.statusCode == statusCode)) {
+      limit = &candidate;
+      break;
+    }
+    if ((now - candidate.lastUse) > (now - oldest->lastUse) || (candidate.lastUse == 0)) {
+      oldest = &candidate;
+    }
+  }
+  if (!limit) {
+    /* replace the least recently used message */
+    limit = oldest;
+    reportSuppressed(*limit, now);
+    limit->hash = hash;
+    limit->statusCode = statusCode;
+    limit->level = level;
+    limit->tokens = MQTT_LOG_LIMIT_BURST;
+    limit->refilled = now;
+    limit->suppressed = 0;
+    strncpy(limit->text, message, MQTT_LOG_LIMIT_TEXT);
+    limit->text[MQTT_LOG_LIMIT_TEXT] = '\0';
+  }
+  limit->lastUse = now ? now : 1;
+
+  while ((limit->tokens < MQTT_LOG_LIMIT_BURST) && ((now - limit->refilled) >= MQTT_LOG_LIMIT_INTERVAL)) {
+    limit->tokens++;
+    limit->refilled += MQTT_LOG_LIMIT_INTERVAL;
+  }
+  if (limit->tokens == MQTT_LOG_LIMIT_BURST) {
+    limit->refilled = now;
+  }
+  if (limit->tokens == 0) {
+    if (limit->suppressed == 0) {
+      limit->suppressedSince = now;
+    }
+    if (limit->suppressed < UINT16_MAX) {
+      limit->suppressed++;
+    }
+    mLogSuppressed++;
+    return false;
+  }
+  limit->tokens--;
+  reportSuppressed(*limit, now);
+  return true;
+}
+
+#ifdef MQTT_LOG_RTC
+static void rtcStore(int level, const char *message, int statusCode)
+{
+  RtcLogRecord record;
+
+  memset(&record, 0, sizeof(record));
+  record.uptime = millis();
+  record.statusCode = statusCode;
+  record.level = level;
+  record.length = strnlen(message, sizeof(record.message));
+  memcpy(record.message, message, record.length);
+  ESP.rtcUserMemoryWrite(RTC_LOG_BLOCK(mRtcHeader.next), (uint32_t *) &record, sizeof(record));
+
+  /* ring: the oldest record is overwritten */
+  mRtcHeader.next = (mRtcHeader.next + 1) % MQTT_LOG_RTC_RECORDS;
+  if (mRtcHeader.count < MQTT_LOG_RTC_RECORDS) {
+    mRtcHeader.count++;
+  }
+  ESP.rtcUserMemoryWrite(MQTT_LOG_RTC_OFFSET, (uint32_t *) &mRtcHeader, sizeof(mRtcHeader));
+}
+#endif
+
+void logSetup()
+{
+#ifdef MQTT_LOG_RTC
+  RtcLogHeader header;
+
+  /* Records of the previous boots, which were never published */
+  if (ESP.rtcUserMemoryRead(MQTT_LOG_RTC_OFFSET, (uint32_t *) &header, sizeof(header))
+      && (header.magic == RTC_LOG_MAGIC) && (header.count <= MQTT_LOG_RTC_RECORDS)
+      && (header.next < MQTT_LOG_RTC_RECORDS)) {
+    mRtcHeader = header;
+    for (uint16_t i = 0; i < header.count; i++) {
+      RtcLogRecord record;
+      char message[MQTT_LOG_RTC_MESSAGE + 1];
+      uint16_t index = (header.next + MQTT_LOG_RTC_RECORDS - header.count + i) % MQTT_LOG_RTC_RECORDS;
+      ESP.rtcUserMemoryRead(RTC_LOG_BLOCK(index), (uint32_t *) &record, sizeof(record));
+      memcpy(message, record.message, sizeof(record.message));
+      message[(record.length < sizeof(record.message)) ? record.length : sizeof(record.message)] = '\0';
+      enqueue(record.level, message, record.statusCode, record.uptime, LOG_FLAG_PREVIOUS_BOOT);
+    }
+  } else {
+    ESP.rtcUserMemoryWrite(MQTT_LOG_RTC_OFFSET, (uint32_t *) &mRtcHeader, sizeof(mRtcHeader));
+  }
+#endif
+}
+
+void logConnected()
+{
+  mConnected = true;
+#ifdef MQTT_LOG_RTC
+  /* everything is queued in RAM and will be published now */
+  mRtcHeader.next = 0;
+  mRtcHeader.count = 0;
+  ESP.rtcUserMemoryWrite(MQTT_LOG_RTC_OFFSET, (uint32_t *) &mRtcHeader, sizeof(mRtcHeader));
+#endif
+  logFlush();
+}
+
+void logLoop()
+{
+  const uint32_t now = millis();
+
+  for (LogLimit &limit : mLogLimits) {
+    if ((limit.suppressed > 0) && ((now - limit.suppressedSince) >= MQTT_LOG_LIMIT_INTERVAL)) {
+      reportSuppressed(limit, now);
+    }
+  }
+  if ((mLogQueueUsed >= MQTT_LOG_FLUSH_SIZE) || ((millis() - mLogLastFlush) >= MQTT_LOG_FLUSH_INTERVAL)) {
+    logFlush();
+  }
+}
+
+uint32_t logDropped()
+{
+  return mLogDropped;
+}
+
+uint32_t logSuppressed()
+{
+  return mLogSuppressed;
+}
+
+uint32_t logBatches()
+{
+  return mLogBatches;
+}
+
+static bool output(int level, const char *message, int statusCode)
+{
+  /* Kept until MQTT is connected, the records are published with their original uptime */
+  bool queued = enqueue(level, message, statusCode, millis(), 0);
+#ifdef MQTT_LOG_RTC
+  if (!mConnected) {
+    rtcStore(level, message, statusCode);
+  }
+#endif
   Homie.getLogger() << (level) << "@" << (statusCode) << " " << (message) << endl;
+  return queued;
+}
+
+/**
+ * @return true, if the message was queued completely
+ */
+bool log(int level, String message, int statusCode)
+{
+  /* debug output (e.g. raw VE.Direct lines) is unique and must not evict the limits of the repeated messages */
+  if (!logEnabled(level) || ((level < MQTT_LEVEL_DEBUG) && !rateLimit(level, message.c_str(), statusCode))) {
+    return false;
+  }
+  return output(level, message.c_str(), statusCode);
 }
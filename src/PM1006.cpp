@@ -0,0 +1,152 @@
+/**
+ * @file PM1006.cpp
+ * @brief Non-blocking receiver of the PM1006 particle sensor
+ * @version 0.1
+ *
+ */
+
+#include "PM1006.h"
+
+PM1006::PM1006(Stream &source) : source_(source)
+{
+
+}
+
+void PM1006::loop()
+{
+    int bytes = 0;
+
+    /* the rest stays in the buffer of the serial, until the next loop; also after a completed frame,
+     * so it is handed over before the next one is received */
+    while ((bytes < PM1006_BYTES_PER_LOOP) && !frame_ready_ && (source_.available() > 0)) {
+        int c = source_.read();
+        if (c < 0) {
+            break;
+        }
+        bytes++;
+        receive((uint8_t) c);
+    }
+}
+
+void PM1006::receive(uint8_t c)
+{
+    uint8_t *frame = frames_buf_[ready_ ^ 1];
+
+    switch (state_) {
+    case STATE_HEADER:
+        if (c != PM1006_HEADER) {
+            skipped_ = true;
+            return;
+        }
+        break;
+    case STATE_LENGTH:
+    case STATE_COMMAND:
+        if (c != ((state_ == STATE_LENGTH) ? PM1006_LENGTH : PM1006_COMMAND)) {
+            /* no header, search again; the byte may start the next one */
+            skipped_ = true;
+            state_ = STATE_HEADER;
+            receive(c);
+            return;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (state_ == STATE_HEADER) {
+        length_ = 0;
+        checksum_ = 0;
+    } else if ((state_ == STATE_COMMAND) && skipped_) {
+        /* complete header found, after dropping some bytes */
+        resyncs_++;
+        skipped_ = false;
+    }
+    frame[length_++] = c;
+    checksum_ += c;
+    if (state_ < STATE_PAYLOAD) {
+        state_++;
+    } else if (length_ >= PM1006_FRAME_LENGTH) {
+        end_frame_();
+    }
+}
+
+void PM1006::end_frame_()
+{
+    state_ = STATE_HEADER;
+    if (checksum_ != 0) {
+        uint8_t rest[PM1006_FRAME_LENGTH - 1];
+
+        bad_frames_++;
+        /* The header may be found within the corrupted frame, e.g. after a truncated one */
+        memcpy(rest, frames_buf_[ready_ ^ 1] + 1, sizeof(rest));
+        skipped_ = true;
+        for (uint8_t i = 0; i < sizeof(rest); i++) {
+            receive(rest[i]);
+        }
+        return;
+    }
+    /* hand over the received frame, the next one is received into the other buffer */
+    ready_ ^= 1;
+    frame_ready_ = true;
+    good_frames_++;
+}
+
+PM1006Filter::PM1006Filter(int maximum) : maximum_(maximum)
+{
+
+}
+
+bool PM1006Filter::add(int value)
+{
+    int median;
+
+    raw_ = value;
+    if ((value < 0) || (value > maximum_)) {
+        rejected_++;
+        return false;
+    }
+    if (count_ > 0) {
+        int difference = value - median_();
+        if ((difference > PM1006_FILTER_MAX_JUMP) || (difference < -PM1006_FILTER_MAX_JUMP)) {
+            if (++jumps_ < PM1006_FILTER_REJECTS) {
+                rejected_++;
+                return false;
+            }
+            /* the air really changed: start again with the new level */
+            count_ = 0;
+            next_ = 0;
+        }
+    }
+    jumps_ = 0;
+
+    samples_[next_] = value;
+    next_ = (next_ + 1) % PM1006_FILTER_SAMPLES;
+    if (count_ < PM1006_FILTER_SAMPLES) {
+        count_++;
+    }
+    median = median_();
+    if (count_ == 1) {
+        average_ = ((int32_t) value) << 4;
+    } else {
+        average_ += ((((int32_t) median) << 4) - average_) / (1 << PM1006_FILTER_EMA_SHIFT);
+    }
+    window_samples_++;
+    return true;
+}
+
+int PM1006Filter::median_()
+{
+    uint16_t sorted[PM1006_FILTER_SAMPLES];
+
+    /* insertion sort of the few samples */
+    for (uint8_t i = 0; i < count_; i++) {
+        uint16_t sample = samples_[i];
+        uint8_t j = i;
+        while ((j > 0) && (sorted[j - 1] > sample)) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = sample;
+    }
+    return sorted[count_ / 2];
+}
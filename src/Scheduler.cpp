@@ -0,0 +1,66 @@
+/**
+ * @file Scheduler.cpp
+ * @brief Cooperative scheduler: each task has its own period, phase and time budget
+ * @version 0.1
+ *
+ */
+
+#include "Scheduler.h"
+
+/**
+ * @brief Add a task
+ * @return id of the task or -1, if no further task is possible
+ */
+int Scheduler::add(const char *name, scheduler_task function, uint32_t period, uint32_t phase, uint32_t budget)
+{
+    if (count_ >= SCHEDULER_TASKS) {
+        return (-1);
+    }
+    tasks_[count_] = { name, function, period, phase, budget, phase };
+    return count_++;
+}
+
+/**
+ * @brief Execute the most overdue task
+ * @return true, if a task was executed
+ */
+bool Scheduler::loop()
+{
+    const uint32_t now = millis();
+    Task *due = NULL;
+    uint32_t started;
+    uint32_t duration;
+
+    if (!started_) {
+        /* the phases are relative to the first loop */
+        for (uint8_t i = 0; i < count_; i++) {
+            tasks_[i].next = now + tasks_[i].phase;
+        }
+        started_ = true;
+    }
+    for (uint8_t i = 0; i < count_; i++) {
+        if (((int32_t) (now - tasks_[i].next) >= 0)
+            && ((due == NULL) || ((int32_t) (tasks_[i].next - due->next) < 0))) {
+            due = &tasks_[i];
+        }
+    }
+    if (due == NULL) {
+        return false;
+    }
+
+    due->next += due->period;
+    if ((int32_t) (now - due->next) >= 0) {
+        /* more than one period late: skip the missed executions */
+        due->next = now + due->period;
+    }
+    started = millis();
+    due->function();
+    duration = millis() - started;
+    if (duration > due->budget) {
+        overruns_++;
+        if (overrun_) {
+            overrun_(due->name, duration, due->budget);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file VictronHex.cpp
+ * @brief VE.Direct HEX protocol: pipelined register get and set
+ * @version 0.1
+ *
+ * Source:
+ * https://www.victronenergy.com/upload/documents/BlueSolar-HEX-protocol.pdf
+ */
+
+#ifdef VICTRON
+#include "VictronHex.h"
+
+namespace victron {
+
+    static const char kHexDigits[] = "0123456789ABCDEF";
+
+    static int hex_nibble(char c)
+    {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        return -1;
+    }
+
+    VictronHex::VictronHex(Stream &port) : port_(port)
+    {
+
+    }
+
+    bool VictronHex::get(uint16_t reg)
+    {
+        return enqueue_(VICTRON_HEX_CMD_GET, reg, 0, 0);
+    }
+
+    bool VictronHex::set(uint16_t reg, uint32_t value, uint8_t size)
+    {
+        return enqueue_(VICTRON_HEX_CMD_SET, reg, value, size);
+    }
+
+    bool VictronHex::enqueue_(uint8_t command, uint16_t reg, uint32_t value, uint8_t size)
+    {
+        Request *free_slot = NULL;
+        for (Request &request : queue_) {
+            if (request.state == SLOT_FREE) {
+                if (!free_slot) {
+                    free_slot = &request;
+                }
+            } else if ((request.command == command) && (request.reg == reg)) {
+                if (command == VICTRON_HEX_CMD_GET) {
+                    /* the pending request delivers the value */
+                    return true;
+                }
+                if (request.state == SLOT_QUEUED) {
+                    /* not sent yet, send the new value instead */
+                    request.value = value;
+                    request.size = size;
+                    return true;
+                }
+            }
+        }
+        if (!free_slot) {
+            return false;
+        }
+        free_slot->state = SLOT_QUEUED;
+        free_slot->command = command;
+        free_slot->reg = reg;
+        free_slot->value = value;
+        free_slot->size = size;
+        free_slot->retries = 0;
+        return true;
+    }
+
+    void VictronHex::transmit_(Request &request, uint32_t now)
+    {
+        /* ':' command, register (2 bytes), flags, value (up to 4 bytes), checksum, '\n' */
+        char frame[2 + ((3 + 4 + 1) * 2) + 2];
+        uint8_t bytes[3 + 4];
+        uint8_t count = 0;
+        uint8_t sum = request.command;
+        uint8_t length = 0;
+
+        bytes[count++] = request.reg & 0xFF;
+        bytes[count++] = request.reg >> 8;
+        bytes[count++] = 0; /* flags */
+        for (uint8_t i = 0; (i < request.size) && (i < 4); i++) {
+            bytes[count++] = (request.value >> (8 * i)) & 0xFF;
+        }
+
+        frame[length++] = ':';
+        frame[length++] = kHexDigits[request.command & 0x0F];
+        for (uint8_t i = 0; i < count; i++) {
+            frame[length++] = kHexDigits[bytes[i] >> 4];
+            frame[length++] = kHexDigits[bytes[i] & 0x0F];
+            sum += bytes[i];
+        }
+        sum = 0x55 - sum;
+        frame[length++] = kHexDigits[sum >> 4];
+        frame[length++] = kHexDigits[sum & 0x0F];
+        frame[length++] = '\n';
+
+        port_.write((const uint8_t *) frame, length);
+        request.state = SLOT_SENT;
+        request.sent_at = now;
+    }
+
+    void VictronHex::loop(uint32_t now)
+    {
+        uint8_t inflight = 0;
+
+        for (Request &request : queue_) {
+            if ((request.state == SLOT_SENT) && (now - request.sent_at >= VICTRON_HEX_TIMEOUT)) {
+                timeouts_++;
+                if (request.retries < VICTRON_HEX_RETRIES) {
+                    request.retries++;
+                    request.state = SLOT_QUEUED;
+                } else {
+                    failures_++;
+                    request.state = SLOT_FREE;
+                }
+            }
+            if (request.state == SLOT_SENT) {
+                inflight++;
+            }
+        }
+
+        /* Pipeline: several requests wait for their response at the same time */
+        for (Request &request : queue_) {
+            if (inflight >= VICTRON_HEX_INFLIGHT) {
+                break;
+            }
+            if (request.state == SLOT_QUEUED) {
+                transmit_(request, now);
+                inflight++;
+            }
+        }
+    }
+
+    bool VictronHex::receive(const char *frame, uint8_t length, VictronHexResponse &response)
+    {
+        uint8_t bytes[VICTRON_HEX_FRAME_MAX / 2];
+        uint8_t count = 0;
+        int command = (length > 0) ? hex_nibble(frame[0]) : -1;
+        uint8_t sum;
+
+        /* command nibble and an even amount of digits */
+        if ((command < 0) || ((length % 2) == 0)) {
+            invalid_frames_++;
+            return false;
+        }
+        sum = command;
+        for (uint8_t i = 1; (i + 1) < length; i += 2) {
+            int high = hex_nibble(frame[i]);
+            int low = hex_nibble(frame[i + 1]);
+            if ((high < 0) || (low < 0)) {
+                invalid_frames_++;
+                return false;
+            }
+            bytes[count] = (high << 4) | low;
+            sum += bytes[count++];
+        }
+        if (sum != 0x55) {
+            invalid_frames_++;
+            return false;
+        }
+
+        /* Only register values are used: register (2 bytes), flags, value, checksum */
+        if (((command != VICTRON_HEX_CMD_GET) && (command != VICTRON_HEX_CMD_SET) && (command != VICTRON_HEX_CMD_ASYNC))
+            || (count < 4)) {
+            return false;
+        }
+        response.command = command;
+        response.reg = bytes[0] | (bytes[1] << 8);
+        response.flags = bytes[2];
+        response.value = 0;
+        for (uint8_t i = 3; (i < (count - 1)) && (i < 7); i++) {
+            response.value |= ((uint32_t) bytes[i]) << (8 * (i - 3));
+        }
+
+        for (Request &request : queue_) {
+            if ((request.state == SLOT_SENT) && (request.command == command) && (request.reg == response.reg)) {
+                request.state = SLOT_FREE;
+                responses_++;
+                break;
+            }
+        }
+        return true;
+    }
+
+}
+#endif /* VICTRON */
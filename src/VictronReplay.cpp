@@ -0,0 +1,69 @@
+/**
+ * @file VictronReplay.cpp
+ * @brief Replay of a recorded VE.Direct capture
+ * @version 0.1
+ *
+ */
+
+#ifdef VICTRON
+#include "VictronReplay.h"
+
+namespace victron {
+
+    VictronReplay::VictronReplay(Stream &capture, uint32_t bitrate) : capture_(capture), bitrate_(bitrate)
+    {
+
+    }
+
+    uint32_t VictronReplay::released_()
+    {
+        if (start_ == 0) {
+            start_ = millis();
+        }
+        if (bitrate_ == VICTRON_REPLAY_MAXSPEED) {
+            return UINT32_MAX;
+        }
+        /* 10 bits per byte: start, 8 data and stop bit */
+        return (uint32_t) (((uint64_t) (millis() - start_) * bitrate_) / 10000);
+    }
+
+    int VictronReplay::available()
+    {
+        uint32_t released = released_();
+        int pending = capture_.available();
+
+        if (bytes_ >= released) {
+            return 0;
+        }
+        return ((released - bytes_) < (uint32_t) pending) ? (int) (released - bytes_) : pending;
+    }
+
+    int VictronReplay::read()
+    {
+        if (available() <= 0) {
+            return -1;
+        }
+        bytes_++;
+        int c = capture_.read();
+        if (capture_.available() <= 0) {
+            end_ = millis();
+            finished_ = true;
+        }
+        return c;
+    }
+
+    int VictronReplay::peek()
+    {
+        if (available() <= 0) {
+            return -1;
+        }
+        return capture_.peek();
+    }
+
+    size_t VictronReplay::write(uint8_t)
+    {
+        return 1;
+    }
+
+}
+#endif /* VICTRON */
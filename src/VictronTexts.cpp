@@ -0,0 +1,275 @@
+/**
+ * @file VictronTexts.cpp
+ * @brief Texts of the codes, sent by Victron devices
+ * @version 0.1
+ *
+ * All texts and tables are stored in flash, the tables are sorted by code.
+ *
+ * Inspired by:
+ * https://github.com/KinDR007/VictronMPPT-ESPHOME/blob/main/components/victron/victron.cpp
+ */
+
+#ifdef VICTRON
+#include "VictronTexts.h"
+
+struct VictronText {
+    uint16_t code;
+    PGM_P text;
+};
+
+#define VICTRON_TEXT_STRING(table, code, text)  static const char table##_##code[] PROGMEM = text;
+#define VICTRON_TEXT_ENTRY(table, code, text)   { code, table##_##code },
+
+static const char kUnknown[] PROGMEM = "Unknown";
+
+#define TRACKING_MODE_TEXTS(X) \
+    X(tracking, 0, "Off") \
+    X(tracking, 1, "Limited") \
+    X(tracking, 2, "Active")
+
+TRACKING_MODE_TEXTS(VICTRON_TEXT_STRING)
+static const VictronText kTrackingModes[] PROGMEM = { TRACKING_MODE_TEXTS(VICTRON_TEXT_ENTRY) };
+
+#define ERROR_CODE_TEXTS(X) \
+    X(error, 0, "No error") \
+    X(error, 2, "Battery voltage too high") \
+    X(error, 17, "Charger temperature too high") \
+    X(error, 18, "Charger over current") \
+    X(error, 19, "Charger current reversed") \
+    X(error, 20, "Bulk time limit exceeded") \
+    X(error, 21, "Current sensor issue") \
+    X(error, 26, "Terminals overheated") \
+    X(error, 28, "Converter issue") \
+    X(error, 33, "Input voltage too high (solar panel)") \
+    X(error, 34, "Input current too high (solar panel)") \
+    X(error, 38, "Input shutdown (excessive battery voltage)") \
+    X(error, 39, "Input shutdown (due to current flow during off mode)") \
+    X(error, 65, "Lost communication with one of devices") \
+    X(error, 66, "Synchronised charging device configuration issue") \
+    X(error, 67, "BMS connection lost") \
+    X(error, 68, "Network misconfigured") \
+    X(error, 116, "Factory calibration data lost") \
+    X(error, 117, "Invalid/incompatible firmware") \
+    X(error, 119, "User settings invalid")
+
+ERROR_CODE_TEXTS(VICTRON_TEXT_STRING)
+static const VictronText kErrorCodes[] PROGMEM = { ERROR_CODE_TEXTS(VICTRON_TEXT_ENTRY) };
+
+#define CHARGING_MODE_TEXTS(X) \
+    X(charging, 0, "Off") \
+    X(charging, 1, "Low power") \
+    X(charging, 2, "Fault") \
+    X(charging, 3, "Bulk") \
+    X(charging, 4, "Absorption") \
+    X(charging, 5, "Float") \
+    X(charging, 6, "Storage") \
+    X(charging, 7, "Equalize (manual)") \
+    X(charging, 9, "Inverting") \
+    X(charging, 11, "Power supply") \
+    X(charging, 245, "Starting-up") \
+    X(charging, 246, "Repeated absorption") \
+    X(charging, 247, "Auto equalize / Recondition") \
+    X(charging, 248, "BatterySafe") \
+    X(charging, 252, "External control")
+
+CHARGING_MODE_TEXTS(VICTRON_TEXT_STRING)
+static const VictronText kChargingModes[] PROGMEM = { CHARGING_MODE_TEXTS(VICTRON_TEXT_ENTRY) };
+
+#define DEVICE_TYPE_TEXTS(X) \
+    X(device, 0x0203, "BMV-700") \
+    X(device, 0x0204, "BMV-702") \
+    X(device, 0x0205, "BMV-700H") \
+    X(device, 0x0300, "BlueSolar MPPT 70|15") \
+    X(device, 0xA040, "BlueSolar MPPT 75|50") \
+    X(device, 0xA041, "BlueSolar MPPT 150|35") \
+    X(device, 0xA042, "BlueSolar MPPT 75|15") \
+    X(device, 0xA043, "BlueSolar MPPT 100|15") \
+    X(device, 0xA044, "BlueSolar MPPT 100|30") \
+    X(device, 0xA045, "BlueSolar MPPT 100|50") \
+    X(device, 0xA046, "BlueSolar MPPT 150|70") \
+    X(device, 0xA047, "BlueSolar MPPT 150|100") \
+    X(device, 0xA049, "BlueSolar MPPT 100|50 rev2") \
+    X(device, 0xA04A, "BlueSolar MPPT 100|30 rev2") \
+    X(device, 0xA04B, "BlueSolar MPPT 150|35 rev2") \
+    X(device, 0xA04C, "BlueSolar MPPT 75|10") \
+    X(device, 0xA04D, "BlueSolar MPPT 150|45") \
+    X(device, 0xA04E, "BlueSolar MPPT 150|60") \
+    X(device, 0xA04F, "BlueSolar MPPT 150|85") \
+    X(device, 0xA050, "SmartSolar MPPT 250|100") \
+    X(device, 0xA051, "SmartSolar MPPT 150|100") \
+    X(device, 0xA052, "SmartSolar MPPT 150|85") \
+    X(device, 0xA053, "SmartSolar MPPT 75|15") \
+    X(device, 0xA054, "SmartSolar MPPT 75|10") \
+    X(device, 0xA055, "SmartSolar MPPT 100|15") \
+    X(device, 0xA056, "SmartSolar MPPT 100|30") \
+    X(device, 0xA057, "SmartSolar MPPT 100|50") \
+    X(device, 0xA058, "SmartSolar MPPT 150|35") \
+    X(device, 0xA059, "SmartSolar MPPT 150|100 rev2") \
+    X(device, 0xA05A, "SmartSolar MPPT 150|85 rev2") \
+    X(device, 0xA05B, "SmartSolar MPPT 250|70") \
+    X(device, 0xA05C, "SmartSolar MPPT 250|85") \
+    X(device, 0xA05D, "SmartSolar MPPT 250|60") \
+    X(device, 0xA05E, "SmartSolar MPPT 250|45") \
+    X(device, 0xA05F, "SmartSolar MPPT 100|20") \
+    X(device, 0xA060, "SmartSolar MPPT 100|20 48V") \
+    X(device, 0xA061, "SmartSolar MPPT 150|45") \
+    X(device, 0xA062, "SmartSolar MPPT 150|60") \
+    X(device, 0xA063, "SmartSolar MPPT 150|70") \
+    X(device, 0xA064, "SmartSolar MPPT 250|85 rev2") \
+    X(device, 0xA065, "SmartSolar MPPT 250|100 rev2") \
+    X(device, 0xA066, "BlueSolar MPPT 100|20") \
+    X(device, 0xA067, "BlueSolar MPPT 100|20 48V") \
+    X(device, 0xA068, "SmartSolar MPPT 250|60 rev2") \
+    X(device, 0xA069, "SmartSolar MPPT 250|70 rev2") \
+    X(device, 0xA06A, "SmartSolar MPPT 150|45 rev2") \
+    X(device, 0xA06B, "SmartSolar MPPT 150|60 rev2") \
+    X(device, 0xA06C, "SmartSolar MPPT 150|70 rev2") \
+    X(device, 0xA06D, "SmartSolar MPPT 150|85 rev3") \
+    X(device, 0xA06E, "SmartSolar MPPT 150|100 rev3") \
+    X(device, 0xA06F, "BlueSolar MPPT 150|45 rev2") \
+    X(device, 0xA070, "BlueSolar MPPT 150|60 rev2") \
+    X(device, 0xA071, "BlueSolar MPPT 150|70 rev2") \
+    X(device, 0xA073, "SmartSolar MPPT 150|45 rev3") \
+    X(device, 0xA074, "SmartSolar MPPT 75|10 rev2") \
+    X(device, 0xA075, "SmartSolar MPPT 75|15 rev2") \
+    X(device, 0xA07D, "BlueSolar MPPT 75|15 rev3") \
+    X(device, 0xA102, "SmartSolar MPPT VE.Can 150/70") \
+    X(device, 0xA103, "SmartSolar MPPT VE.Can 150/45") \
+    X(device, 0xA104, "SmartSolar MPPT VE.Can 150/60") \
+    X(device, 0xA105, "SmartSolar MPPT VE.Can 150/85") \
+    X(device, 0xA106, "SmartSolar MPPT VE.Can 150/100") \
+    X(device, 0xA107, "SmartSolar MPPT VE.Can 250/45") \
+    X(device, 0xA108, "SmartSolar MPPT VE.Can 250/60") \
+    X(device, 0xA109, "SmartSolar MPPT VE.Can 250/70") \
+    X(device, 0xA10A, "SmartSolar MPPT VE.Can 250/85") \
+    X(device, 0xA10B, "SmartSolar MPPT VE.Can 250/100") \
+    X(device, 0xA10C, "SmartSolar MPPT VE.Can 150/70 rev2") \
+    X(device, 0xA10D, "SmartSolar MPPT VE.Can 150/85 rev2") \
+    X(device, 0xA10E, "SmartSolar MPPT VE.Can 150/100 rev2") \
+    X(device, 0xA10F, "BlueSolar MPPT VE.Can 150/100") \
+    X(device, 0xA112, "BlueSolar MPPT VE.Can 250/70") \
+    X(device, 0xA113, "BlueSolar MPPT VE.Can 250/100") \
+    X(device, 0xA114, "SmartSolar MPPT VE.Can 250/70 rev2") \
+    X(device, 0xA115, "SmartSolar MPPT VE.Can 250/100 rev2") \
+    X(device, 0xA116, "SmartSolar MPPT VE.Can 250/85 rev2") \
+    X(device, 0xA201, "Phoenix Inverter 12V 250VA 230V") \
+    X(device, 0xA202, "Phoenix Inverter 24V 250VA 230V") \
+    X(device, 0xA204, "Phoenix Inverter 48V 250VA 230V") \
+    X(device, 0xA211, "Phoenix Inverter 12V 375VA 230V") \
+    X(device, 0xA212, "Phoenix Inverter 24V 375VA 230V") \
+    X(device, 0xA214, "Phoenix Inverter 48V 375VA 230V") \
+    X(device, 0xA221, "Phoenix Inverter 12V 500VA 230V") \
+    X(device, 0xA222, "Phoenix Inverter 24V 500VA 230V") \
+    X(device, 0xA224, "Phoenix Inverter 48V 500VA 230V") \
+    X(device, 0xA231, "Phoenix Inverter 12V 250VA 230V") \
+    X(device, 0xA232, "Phoenix Inverter 24V 250VA 230V") \
+    X(device, 0xA234, "Phoenix Inverter 48V 250VA 230V") \
+    X(device, 0xA239, "Phoenix Inverter 12V 250VA 120V") \
+    X(device, 0xA23A, "Phoenix Inverter 24V 250VA 120V") \
+    X(device, 0xA23C, "Phoenix Inverter 48V 250VA 120V") \
+    X(device, 0xA241, "Phoenix Inverter 12V 375VA 230V") \
+    X(device, 0xA242, "Phoenix Inverter 24V 375VA 230V") \
+    X(device, 0xA244, "Phoenix Inverter 48V 375VA 230V") \
+    X(device, 0xA249, "Phoenix Inverter 12V 375VA 120V") \
+    X(device, 0xA24A, "Phoenix Inverter 24V 375VA 120V") \
+    X(device, 0xA24C, "Phoenix Inverter 48V 375VA 120V") \
+    X(device, 0xA251, "Phoenix Inverter 12V 500VA 230V") \
+    X(device, 0xA252, "Phoenix Inverter 24V 500VA 230V") \
+    X(device, 0xA254, "Phoenix Inverter 48V 500VA 230V") \
+    X(device, 0xA259, "Phoenix Inverter 12V 500VA 120V") \
+    X(device, 0xA25A, "Phoenix Inverter 24V 500VA 120V") \
+    X(device, 0xA25C, "Phoenix Inverter 48V 500VA 120V") \
+    X(device, 0xA261, "Phoenix Inverter 12V 800VA 230V") \
+    X(device, 0xA262, "Phoenix Inverter 24V 800VA 230V") \
+    X(device, 0xA264, "Phoenix Inverter 48V 800VA 230V") \
+    X(device, 0xA269, "Phoenix Inverter 12V 800VA 120V") \
+    X(device, 0xA26A, "Phoenix Inverter 24V 800VA 120V") \
+    X(device, 0xA26C, "Phoenix Inverter 48V 800VA 120V") \
+    X(device, 0xA271, "Phoenix Inverter 12V 1200VA 230V") \
+    X(device, 0xA272, "Phoenix Inverter 24V 1200VA 230V") \
+    X(device, 0xA274, "Phoenix Inverter 48V 1200VA 230V") \
+    X(device, 0xA279, "Phoenix Inverter 12V 1200VA 120V") \
+    X(device, 0xA27A, "Phoenix Inverter 24V 1200VA 120V") \
+    X(device, 0xA27C, "Phoenix Inverter 48V 1200VA 120V") \
+    X(device, 0xA281, "Phoenix Inverter 12V 1600VA 230V") \
+    X(device, 0xA282, "Phoenix Inverter 24V 1600VA 230V") \
+    X(device, 0xA284, "Phoenix Inverter 48V 1600VA 230V") \
+    X(device, 0xA291, "Phoenix Inverter 12V 2000VA 230V") \
+    X(device, 0xA292, "Phoenix Inverter 24V 2000VA 230V") \
+    X(device, 0xA294, "Phoenix Inverter 48V 2000VA 230V") \
+    X(device, 0xA2A1, "Phoenix Inverter 12V 3000VA 230V") \
+    X(device, 0xA2A2, "Phoenix Inverter 24V 3000VA 230V") \
+    X(device, 0xA2A4, "Phoenix Inverter 48V 3000VA 230V") \
+    X(device, 0xA2F9, "Phoenix Inverter 12V 1200VA 120V") \
+    X(device, 0xA30A, "Blue Smart IP65 Charger 12|25") \
+    X(device, 0xA332, "Blue Smart IP22 Charger 24|8") \
+    X(device, 0xA334, "Blue Smart IP22 Charger 24|12") \
+    X(device, 0xA336, "Blue Smart IP22 Charger 24|16") \
+    X(device, 0xA340, "Phoenix Smart IP43 Charger 12|50 (1+1)") \
+    X(device, 0xA341, "Phoenix Smart IP43 Charger 12|50 (3)") \
+    X(device, 0xA342, "Phoenix Smart IP43 Charger 24|25 (1+1)") \
+    X(device, 0xA343, "Phoenix Smart IP43 Charger 24|25 (3)") \
+    X(device, 0xA344, "Phoenix Smart IP43 Charger 12|30 (1+1)") \
+    X(device, 0xA345, "Phoenix Smart IP43 Charger 12|30 (3)") \
+    X(device, 0xA346, "Phoenix Smart IP43 Charger 24|16 (1+1)") \
+    X(device, 0xA347, "Phoenix Smart IP43 Charger 24|16 (3)") \
+    X(device, 0xA381, "BMV-712 Smart") \
+    X(device, 0xA382, "BMV-710H Smart") \
+    X(device, 0xA383, "BMV-712 Smart Rev2") \
+    X(device, 0xA389, "SmartShunt 500A/50mV") \
+    X(device, 0xA38A, "SmartShunt 1000A/50mV") \
+    X(device, 0xA38B, "SmartShunt 2000A/50mV") \
+    X(device, 0xA442, "Multi RS Solar 48V 6000VA 230V")
+
+DEVICE_TYPE_TEXTS(VICTRON_TEXT_STRING)
+static const VictronText kDeviceTypes[] PROGMEM = { DEVICE_TYPE_TEXTS(VICTRON_TEXT_ENTRY) };
+
+#define TABLE_SIZE(table)   (sizeof(table) / sizeof(table[0]))
+
+/**
+ * @brief Binary search in a sorted table
+ * @return text in flash, "Unknown" if the code is not part of the table
+ */
+static PGM_P find_text(const VictronText *table, size_t count, long code)
+{
+    size_t low = 0;
+    size_t high = count;
+
+    if ((code < 0) || (code > 0xFFFF)) {
+        return kUnknown;
+    }
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        long entry = pgm_read_word(&table[mid].code);
+        if (entry == code) {
+            return (PGM_P) pgm_read_ptr(&table[mid].text);
+        }
+        if (entry < code) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return kUnknown;
+}
+
+PGM_P tracking_mode_text(int value)
+{
+    return find_text(kTrackingModes, TABLE_SIZE(kTrackingModes), value);
+}
+
+PGM_P error_code_text(int value)
+{
+    return find_text(kErrorCodes, TABLE_SIZE(kErrorCodes), value);
+}
+
+PGM_P charging_mode_text(int value)
+{
+    return find_text(kChargingModes, TABLE_SIZE(kChargingModes), value);
+}
+
+PGM_P device_type_text(long value)
+{
+    return find_text(kDeviceTypes, TABLE_SIZE(kDeviceTypes), value);
+}
+#endif /* VICTRON */
@@ -16,14 +16,23 @@
 #include <SoftwareSerial.h>
 #include "HomieSettings.h"
 #include "MqttLog.h"
+#include "PM1006.h"
+#include "Deadband.h"
+#include "Scheduler.h"
+#include "Format.h"
+#include "Altitude.h"
 #include <Adafruit_NeoPixel.h>
 #include <Wire.h>
 #include <Adafruit_Sensor.h>
 #ifdef VICTRON
 #include <victron.h>
+#ifdef VICTRON_CAPTURE
+#include "VictronReplay.h"
+#endif
 #endif
 #ifdef BME680
 #include "Adafruit_BME680.h"
+#include "IaqBaseline.h"
 #else
 #ifdef BMP280
 #include "Adafruit_BMP280.h"
@@ -44,12 +53,26 @@
 #define WITTY_RGB_B         D7 /**< GPIO13 */
 #define PM1006_BIT_RATE     9600
 #define PM1006_MQTT_UPDATE  30000 /**< Check the sensor every 30 seconds; New measurement is done every 20seconds by the PM1006 sensor */
+#define TASK_PHASE_BMX      10000   /**< ms after the particle publish, the BOSCH values are published */
+#define TASK_PHASE_MPPT     20000   /**< ms after the particle publish, the Victron values are published */
+#define TASK_CYCLE_DELAY    2000    /**< ms after the last sensor publish, the cycle ends (and the deep sleep starts) */
+#define TASK_BUDGET_PARTICLE    50  /**< ms for publishing the particle values */
+#define TASK_BUDGET_BMX         100 /**< ms for collecting and publishing the BOSCH values */
+#define TASK_BUDGET_MPPT        150 /**< ms for publishing all chargers */
+#define TASK_BUDGET_CYCLE       150 /**< ms for the statistics and preparing the deep sleep */
+#define DECIMALS_TEMPERATURE    2   /**< Published decimals of the temperature (°C), at most 2 are measured */
+#define DECIMALS_PRESSURE       2   /**< Published decimals of the pressure (hPa), at most 2 are measured */
+#define DECIMALS_ALTITUDE       2   /**< Published decimals of the altitude (m), at most 2 are calculated */
+#define DECIMALS_GAS            2   /**< Published decimals of the gas resistance (kOhm), at most 3 are measured */
+#define DECIMALS_HUMIDITY       2   /**< Published decimals of the humidity (%), at most 2 are measured */
 #define PIXEL_COUNT         3
 #define GPIO_BUTTON   SENSOR_PM1006_RX /**< Button and software serial share one pin on Witty board */
 #define SENSOR_I2C_SCK    D5 /**< GPIO14 - I2C clock pin */
 #define SENSOR_I2C_SDI    D1 /**< GPIO5  - I2C data pin */
 
-#define SEALEVELPRESSURE_HPA (1013.25)
+#define BMX_DURATION_MARGIN     10      /**< ms, the measurement is started additionally before the publish */
+#define BMX_DURATION_BME680     250     /**< ms, first guess of a measurement with gas heater */
+#define BMX_DURATION_MAX        100     /**< ms, the BMP280 needs at most 44 ms with 16x oversampling */
 
 #define BUTTON_MAX_CYCLE        10000U  /**< Action: Reset configuration */
 #define BUTTON_MIN_ACTION_CYCLE 55U     /**< Minimum cycle to react on the button (e.g. 5 second) */
@@ -62,30 +85,114 @@
 
 #define PERCENT2FACTOR(b, a)               ((b * a.get()) / 100)
 
+#ifdef VICTRON
+#define SERIAL_DEBUG(text)      /**< Serial is connected to the charger, nothing is printed */
+#else
+#define SERIAL_DEBUG(text)      printf(text)
+#endif
+
 #define NUMBER_TYPE                     "Number"
 #define NODE_PARTICLE                   "particle"
+#define NODE_PARTICLE_RAW               "raw"
+#define NODE_PARTICLE_SAMPLES           "samples"
+#define NODE_PARTICLE_PM1               "pm1"
+#define NODE_PARTICLE_PM10              "pm10"
+#define NODE_PARTICLE_STATUS            "status"
+#define NODE_PARTICLE_GOODFRAMES        "good"
+#define NODE_PARTICLE_BADFRAMES         "bad"
+#define NODE_PARTICLE_RESYNCS           "resync"
+#define NODE_PARTICLE_OVERFLOWS         "overflow"
+#define NODE_PARTICLE_REJECTED          "rejected"
 #define NODE_TEMPERATUR                 "temp"
 #define NODE_PRESSURE                   "pressure"
 #define NODE_ALTITUDE                   "altitude"
 #define NODE_GAS                        "gas"
+#define NODE_GAS_IAQ                    "iaq"
+#define NODE_GAS_BASELINE               "baseline"
 #define NODE_HUMIDITY                   "humidity"
+#define NODE_BMX_LATENCY                "latency"
+#define NODE_BMX_DURATION               "duration"
 #define NODE_AMBIENT                    "ambient"
 #define NODE_BUTTON                     "button"
+#define NODE_PUBLISH                    "publish"
+#define NODE_PUBLISH_SENT               "sent"
+#define NODE_PUBLISH_SUPPRESSED         "suppressed"
+#define NODE_PUBLISH_OVERRUNS           "overruns"
+#define NODE_PUBLISH_LOGDROPPED         "logDropped"
+#define NODE_PUBLISH_LOGSUPPRESSED      "logSuppressed"
+#define NODE_PUBLISH_LOGBATCHES         "logBatches"
+#define DEADBAND_IAQ                    5       /**< Index points */
+#define DEADBAND_GAS_BASELINE           1000    /**< Ohm */
+#define DEADBAND_VOLTAGE                50      /**< mV of battery and panel */
+#define DEADBAND_CURRENT                100     /**< mA of the battery */
+#define DEADBAND_ALTITUDE               100     /**< cm */
+#define DEADBAND_DURATION               20      /**< ms of the BOSCH measurement and its latency */
 #define NODE_MPPT                       "mppt"
+#define NODE_MPPT_GOODFRAMES            "good"
+#define NODE_MPPT_BADFRAMES             "bad"
+#define NODE_MPPT_TRUNCATEDFRAMES       "truncated"
+#define NODE_MPPT_OVERLONGFIELDS        "overlong"
+#define NODE_MPPT_UNKNOWNLABELS         "unknown"
+#define NODE_MPPT_HEXRESPONSES          "hexResponses"
+#define NODE_MPPT_HEXTIMEOUTS           "hexTimeouts"
+#define NODE_MPPT_HEXFAILURES           "hexFailures"
+#define NODE_MPPT_HEXINVALID            "hexInvalid"
+#define NODE_MPPT_LOADCONTROL           "load"
+#define NODE_MPPT_DEBUG                 "debug"
+#define NODE_MPPT_DEBUGDROPPED          "debugDropped"
+#define MPPT_LOADCONTROL_FORMAT         "off,auto,alt1,alt2,on" /**< Index is the value of the load output control register */
 #define NODE_SOLAR                      "solar"
 #define NODE_SOLAR_BATTERYVOLT          "batteryV"
 #define NODE_SOLAR_PANELPOWER           "panelP"
 #define NODE_SOLAR_PANELVOLT            "panelV"
-#define SERIAL_RCEVBUF_MAX                80      /**< Maximum 80 characters can be received from the PM1006 sensor */
+#define NODE_SOLAR_BATTERYVOLT_MIN      "batteryVmin"
+#define NODE_SOLAR_BATTERYVOLT_MAX      "batteryVmax"
+#define NODE_SOLAR_BATTERYVOLT_MEAN     "batteryVavg"
+#define NODE_SOLAR_BATTERYCURR_MIN      "batteryImin"
+#define NODE_SOLAR_BATTERYCURR_MAX      "batteryImax"
+#define NODE_SOLAR_BATTERYCURR_MEAN     "batteryIavg"
+#define NODE_SOLAR_PANELPOWER_MIN       "panelPmin"
+#define NODE_SOLAR_PANELPOWER_MAX       "panelPmax"
+#define NODE_SOLAR_PANELPOWER_MEAN      "panelPavg"
+#define NODE_SOLAR_BATTERYENERGY        "batteryE"
+#define NODE_SOLAR_PANELENERGY          "panelE"
+#define NODE_SOLAR_FRAMES               "frames"
+#define NODE_SOLAR_TOTAL                "solarTotal"
+#define NODE_SOLAR_YIELD_TODAY          "yieldToday"
+#define NODE_SOLAR_YIELD_TOTAL          "yieldTotal"
+#ifndef VICTRON_COUNT
+#define VICTRON_COUNT                   1       /**< Amount of Victron chargers */
+#endif
+#ifndef VICTRON_RX_PINS
+#define VICTRON_RX_PINS                 { WITTY_RGB_B } /**< SoftwareSerial RX of the second and third charger */
+#endif
+#ifndef VICTRON_RX_BUFFER
+#define VICTRON_RX_BUFFER               192     /**< Bytes of each SoftwareSerial, 100 ms at 19200 baud (default 64: 33 ms) */
+#endif
+#ifndef VICTRON_REPLAY_BITRATE
+#define VICTRON_REPLAY_BITRATE          SERIAL_BAUDRATE /**< Timing of the replay, VICTRON_REPLAY_MAXSPEED (0) without any delay */
+#endif
 /******************************************************************************
  *                                     TYPE DEFS
  ******************************************************************************/
 
+/** One measurement of the BOSCH sensor, everything published is taken from here */
+typedef struct {
+  int32_t temperature;  /**< 0.01 °C */
+  int32_t pressure;     /**< Pa */
+  int32_t altitude;     /**< cm, calculated from the pressure */
+#ifdef BME680
+  int32_t humidity;     /**< 0.01 % */
+  uint32_t gas;         /**< Ohm */
+  int iaq;              /**< 0 (excellent) to 500, -1 during burn-in */
+#endif
+} BmxSnapshot;
+
 /******************************************************************************
  *                            FUNCTION PROTOTYPES
  ******************************************************************************/
 
-void log(int level, String message, int code);
+bool log(int level, String message, int code);
 
 /******************************************************************************
  *                            LOCAL VARIABLES
@@ -107,16 +214,26 @@ HomieNode gasNode(NODE_GAS, "Gas", "number");
 HomieNode humidityNode(NODE_HUMIDITY, "Humidity", "number");
 #endif
 HomieNode buttonNode(NODE_BUTTON, "Button", "number");
+HomieNode publishNode(NODE_PUBLISH, "Published messages", "number");
 
 #ifdef VICTRON
-HomieNode mpptNode(NODE_MPPT, "MPPT", "json");
-HomieNode solarNode(NODE_SOLAR, "Solar", "number");
+/* one node per charger, created in setup() */
+static const char *const mMpptNodeIds[] = { NODE_MPPT, NODE_MPPT "2", NODE_MPPT "3" };
+static const char *const mSolarNodeIds[] = { NODE_SOLAR, NODE_SOLAR "2", NODE_SOLAR "3" };
+static_assert(VICTRON_COUNT <= (sizeof(mMpptNodeIds) / sizeof(mMpptNodeIds[0])), "Too many Victron chargers");
+HomieNode *mpptNode[VICTRON_COUNT];
+HomieNode *solarNode[VICTRON_COUNT];
+#if VICTRON_COUNT > 1
+HomieNode solarTotalNode(NODE_SOLAR_TOTAL, "Solar total", "number");
+#endif
 #endif
 
 /****************************** Output control ***********************/
 HomieNode ledStripNode /* to rule them all */("led", "RGB led", "color");
 
 /************************** Settings ******************************/
+/* Homie reads at most ten settings (MAX_CONFIG_SETTING_SIZE in Limits.hpp) out of the config.json,
+ * therefore related values are combined into one setting as comma separated list */
 HomieSetting<bool> i2cEnable("i2c", 
 #ifdef BME680
 "BME680 sensor present"
@@ -129,13 +246,48 @@ HomieSetting<bool> i2cEnable("i2c",
 #endif
 
 );
+#ifdef BME680
+HomieSetting<const char *> bmxSetting("bmx", "Oversampling of temperature (1, 2, 4, 8 or 16), pressure and humidity (0 - skipped, 1, 2, 4, 8 or 16), "
+                                           "IIR filter coefficient (0 - off, 1, 3, 7, 15, 31, 63 or 127); default 8,4,2,0");
+#else
+HomieSetting<const char *> bmxSetting("bmx", "Oversampling of temperature (1, 2, 4, 8 or 16), pressure (0 - skipped, 1, 2, 4, 8 or 16), "
+                                           "unused, IIR filter coefficient (0 - off, 2, 4, 8 or 16); default 2,16,,0");
+#endif
+HomieSetting<const char *> publishSetting("publish", "Heartbeat (s), after which unchanged values are published again, and the changes, which are published before: "
+                                                   "temperature (°C), pressure (hPa), particles (micro gram per quibik), humidity (%), gas (KOhm), solar power (W); "
+                                                   "default 300,0.1,0.5,2,1,5,2");
+HomieSetting<const char *> scheduleSetting("schedule", "Period and phase (s) of the particle, BOSCH and Victron publishes; "
+                                                     "the phase is the delay after the start; default 30,0,30,10,30,20");
 HomieSetting<bool> rgbTemp("rgbTemp", "Show temperature via red (>20 °C) and blue (< 20°C)");
 HomieSetting<long> rgbDim("rgbDim", "Factor (1 to 200%) of the status LEDs");
 HomieSetting<long> deepsleep("deepsleep", "Amount of seconds to sleep (default 0 - always online, maximum 4294 - 71 minutes)");
+HomieSetting<long> logLevel("logLevel", "Messages up to this level are logged via MQTT (1 error, 10 warning, 20 info, 90 debug; default 90)");
+
+/** Values of the setting "bmx" */
+enum BmxSettingIndex { BMX_OS_TEMPERATURE = 0, BMX_OS_PRESSURE, BMX_OS_HUMIDITY, BMX_IIR, BMX_SETTINGS };
+/** Values of the setting "publish" */
+enum PublishSettingIndex { PUBLISH_HEARTBEAT = 0, PUBLISH_TEMPERATURE, PUBLISH_PRESSURE, PUBLISH_PARTICLE,
+                           PUBLISH_HUMIDITY, PUBLISH_GAS, PUBLISH_POWER, PUBLISH_SETTINGS };
+/** Values of the setting "schedule" */
+enum ScheduleSettingIndex { SCHEDULE_PARTICLE_PERIOD = 0, SCHEDULE_PARTICLE_PHASE, SCHEDULE_BMX_PERIOD, SCHEDULE_BMX_PHASE,
+                            SCHEDULE_MPPT_PERIOD, SCHEDULE_MPPT_PHASE, SCHEDULE_SETTINGS };
+
+/* Defaults, replaced by the given entries of the settings; empty entries keep the default */
+#ifdef BME680
+double mBmxSettings[BMX_SETTINGS] = { 8, 4, 2, 0 };
+#else
+double mBmxSettings[BMX_SETTINGS] = { 2, 16, 0, 0 };
+#endif
+double mPublishSettings[PUBLISH_SETTINGS] = { DEADBAND_HEARTBEAT_DEFAULT / 1000, 0.1, 0.5, 2, 1, 5, 2 };
+double mScheduleSettings[SCHEDULE_SETTINGS] = { PM1006_MQTT_UPDATE / 1000, 0, PM1006_MQTT_UPDATE / 1000, TASK_PHASE_BMX / 1000,
+                                                PM1006_MQTT_UPDATE / 1000, TASK_PHASE_MPPT / 1000 };
 
 static SoftwareSerial pmSerial(SENSOR_PM1006_RX, SENSOR_PM1006_TX);
+PM1006 pm1006(pmSerial);
+PM1006Filter pmFilter(PM_MAX);
 #ifdef BME680
 Adafruit_BME680 bmx(&Wire); // connected via I2C
+IaqBaseline mIaq;
 #else
 #ifdef BMP280
 Adafruit_BMP280 bmx; // connected via I2C
@@ -146,79 +298,406 @@ Adafruit_NeoPixel strip(PIXEL_COUNT, GPIO_WS2812, NEO_GRB + NEO_KHZ800);
 
 #ifdef VICTRON
 HomieSetting<bool> deepsleepMppt("dsleepMppt", "Deep sleep only after MPPT comminication (default 0 / false: sleep without any info from Victron)");
-victron::VictronComponent mppt(0);
+HomieSetting<bool> debugMppt("mpptDebug", "Log the raw VE.Direct lines via MQTT (default 0 / false; can be changed via the debug property)");
+#ifdef VICTRON_CAPTURE
+/* Replay a recorded capture from the filesystem instead of the UART */
+File mpptCapture;
+victron::VictronReplay mpptReplay(mpptCapture, VICTRON_REPLAY_BITRATE);
+#endif
+victron::VictronComponent *mppt[VICTRON_COUNT]; /**< first charger on the UART, all others via SoftwareSerial */
+uint8_t mMpptFirst = 0;                         /**< Charger, parsed first with the next loop */
+/** Last published values of one charger; the counters are only published with the heartbeat */
+struct MpptPublish {
+  Deadband json;
+  Deadband goodFrames { DEADBAND_HEARTBEAT_ONLY };
+  Deadband badFrames { DEADBAND_HEARTBEAT_ONLY };
+  Deadband truncatedFrames { DEADBAND_HEARTBEAT_ONLY };
+  Deadband overlongFields { DEADBAND_HEARTBEAT_ONLY };
+  Deadband unknownLabels { DEADBAND_HEARTBEAT_ONLY };
+  Deadband hexResponses { DEADBAND_HEARTBEAT_ONLY };
+  Deadband hexTimeouts { DEADBAND_HEARTBEAT_ONLY };
+  Deadband hexFailures { DEADBAND_HEARTBEAT_ONLY };
+  Deadband hexInvalid { DEADBAND_HEARTBEAT_ONLY };
+  Deadband debugDropped { DEADBAND_HEARTBEAT_ONLY };
+  Deadband loadControl;
+  Deadband debug;
+  Deadband batteryVoltage { DEADBAND_VOLTAGE };
+  Deadband panelVoltage { DEADBAND_VOLTAGE };
+  Deadband panelPower;      /**< width of the setting */
+  Deadband batteryVoltageMin { DEADBAND_VOLTAGE };
+  Deadband batteryVoltageMax { DEADBAND_VOLTAGE };
+  Deadband batteryVoltageMean { DEADBAND_VOLTAGE };
+  Deadband batteryCurrentMin { DEADBAND_CURRENT };
+  Deadband batteryCurrentMax { DEADBAND_CURRENT };
+  Deadband batteryCurrentMean { DEADBAND_CURRENT };
+  Deadband panelPowerMin;   /**< width of the setting */
+  Deadband panelPowerMax;
+  Deadband panelPowerMean;
+  Deadband batteryEnergy;   /**< energy and frames of the window: each change */
+  Deadband panelEnergy;
+  Deadband frames;
+};
+MpptPublish mPublishMppt[VICTRON_COUNT];
+#if VICTRON_COUNT > 1
+Deadband mPublishTotalPower;
+Deadband mPublishTotalYield;
+
+/* All other GPIOs of the Witty board are used by the sensors, the button and deep sleep (GPIO16) or select
+ * the boot mode (GPIO0, GPIO2, GPIO15). The blue LED is given up for the second charger, further chargers
+ * need a pin freed on the board.
+ */
+static constexpr uint8_t mMpptRxPins[] = VICTRON_RX_PINS;
+#define MPPT_RX_PINS    (sizeof(mMpptRxPins) / sizeof(mMpptRxPins[0]))
+static_assert(MPPT_RX_PINS == (VICTRON_COUNT - 1),
+              "VICTRON_RX_PINS needs one pin for each charger after the first");
+
+constexpr bool mpptRxPinValid(uint8_t pin) {
+  return (pin != D0) && (pin != D3) && (pin != D4) && (pin != D8) &&
+         (pin != SENSOR_PM1006_RX) && (pin != SENSOR_I2C_SCK) && (pin != SENSOR_I2C_SDI) && (pin != WITTY_RGB_G);
+}
+
+constexpr bool mpptRxPinsValid(size_t index = 0) {
+  return (index >= MPPT_RX_PINS) || (mpptRxPinValid(mMpptRxPins[index]) && mpptRxPinsValid(index + 1));
+}
+static_assert(mpptRxPinsValid(), "VICTRON_RX_PINS contains a strapping pin or a pin of a sensor");
+
+constexpr bool mpptRxPin(uint8_t pin, size_t index = 0) {
+  return (index < MPPT_RX_PINS) && ((mMpptRxPins[index] == pin) || mpptRxPin(pin, index + 1));
+}
+#endif
+#endif
+
+#if defined(VICTRON) && (VICTRON_COUNT > 1)
+static constexpr bool mBlueLed = !mpptRxPin(WITTY_RGB_B);   /**< the pin of the blue LED may receive a charger */
+#else
+static constexpr bool mBlueLed = true;
 #endif
 
 // Variablen
-uint8_t serialRxBuf[SERIAL_RCEVBUF_MAX];
-uint8_t rxBufIdx = 0;
 int mParticle_pM25 = 0;
+uint32_t mParticleOverflows = 0;   /**< the receive buffer of pmSerial was full, bytes were lost */
 int last = 0;
 unsigned int mButtonPressed = 0;
 bool mSomethingReceived = false;
 
 uint32_t      mMeasureIndex = 0;
 
+BmxSnapshot mBmx;
+
+/* last published values */
+Deadband mPublishParticle;
+Deadband mPublishRaw;
+Deadband mPublishPm1;
+Deadband mPublishPm10;
+Deadband mPublishStatus;
+Deadband mPublishSamples;
+Deadband mPublishParticleGood(DEADBAND_HEARTBEAT_ONLY);
+Deadband mPublishParticleBad(DEADBAND_HEARTBEAT_ONLY);
+Deadband mPublishParticleResyncs(DEADBAND_HEARTBEAT_ONLY);
+Deadband mPublishParticleOverflows(DEADBAND_HEARTBEAT_ONLY);
+Deadband mPublishParticleRejected(DEADBAND_HEARTBEAT_ONLY);
+Deadband mPublishAltitude(DEADBAND_ALTITUDE);
+Deadband mPublishBmxLatency(DEADBAND_DURATION);
+Deadband mPublishBmxDuration(DEADBAND_DURATION);
+Deadband mPublishButton;
+Deadband mPublishTemperature;
+Deadband mPublishPressure;
+#ifdef BME680
+Deadband mPublishGas;
+Deadband mPublishIaq(DEADBAND_IAQ);
+Deadband mPublishBaseline(DEADBAND_GAS_BASELINE);
+Deadband mPublishHumidity;
+#endif
+bool mBmxMeasuring = false;     /**< measurement started, result not collected yet */
+bool mBmxValid = false;         /**< snapshot not published yet */
+unsigned long mBmxStarted = 0;
+unsigned long mBmxFinished = 0;
+unsigned long mBmxConversion = 0; /**< ms of a measurement according to the datasheet, used to schedule the start */
+unsigned long mBmxDuration = 0; /**< ms of the last measurement, as measured */
+
+Scheduler mScheduler;
+int mTaskBmx = -1;               /**< the BOSCH measurement is started before this task */
+
 /******************************************************************************
  *                            LOCAL FUNCTIONS
  *****************************************************************************/
 
+/**
+ * @brief Send a number, if it changed more than the deadband or the heartbeat elapsed
+ * @param decimals of the scaled value
+ */
+void publishNumber(HomieNode &node, const char *property, Deadband &deadband, long value, uint8_t decimals = 0) {
+  char number[FORMAT_NUMBER_MAX];
+  if (deadband.check(value)) {
+    node.setProperty(property).send(formatNumber(number, value, decimals));
+  }
+}
+
+/**
+ * @brief Send a counter, if it changed more than the deadband or the heartbeat elapsed
+ */
+void publishCounter(HomieNode &node, const char *property, Deadband &deadband, uint32_t value) {
+  char number[FORMAT_NUMBER_MAX];
+  if (deadband.check((long) value)) {
+    node.setProperty(property).send(formatUnsigned(number, value));
+  }
+}
+
+/**
+ * @brief Send a text, if it changed or the heartbeat elapsed
+ */
+void publishText(HomieNode &node, const char *property, Deadband &deadband, const char *text) {
+  if (deadband.check(text)) {
+    node.setProperty(property).send(text);
+  }
+}
+
 /**
  * @brief Log Victron communication plain to MQTT
  * 
- * @param uartLine one complete line, received on VC.Direct Bus
+ * @param uartLines several complete lines, received on VC.Direct Bus, separated by a newline
  */
-void mqttLog_callback(std::string uartLine)
+bool mqttLog_callback(const char *uartLines)
 {
-  log(MQTT_LEVEL_DEBUG, String(uartLine.c_str()), MQTT_LOG_VICTRON);
+  /* lines, which are filtered by the log level, are not delivered either */
+  return logEnabled(MQTT_LEVEL_DEBUG) && log(MQTT_LEVEL_DEBUG, String(uartLines), MQTT_LOG_VICTRON);
 }
 
 /**
- * @brief Get the Sensor Data from software serial
+ * @brief Get the Sensor Data, received and filtered in the background
  * 
- * @return int PM25 value
+ * @return int filtered PM25 value or -1, if no valid sample was received since the last call
  */
 int getSensorData() {
-  uint8_t rxBufIdx = 0;
-  uint8_t checksum = 0;
+  const uint8_t *frame = pm1006.getFrame().getBytes();
 
-  // Sensor Serial aushorchen
-  while ((pmSerial.available() && rxBufIdx < 127) || rxBufIdx < 20) 
-  {
-    serialRxBuf[rxBufIdx++] = pmSerial.read();
-    delay(15);
+  if (pmFilter.getWindowSamples() == 0) {
+    return (-1);
   }
 
-  // calculate checksum
-  for (uint8_t i = 0; i < 20; i++) 
-  {
-    checksum += serialRxBuf[i];
+  /* Debug Print of the latest received bytes */
+  if (logEnabled(MQTT_LEVEL_DEBUG)) {
+    /* formatted only, if debug messages are logged */
+    static const char hexDigits[] = "0123456789abcdef";
+    char dbgBuffer[8 + (PM1006_FRAME_LENGTH * 2) + 1] = "PM1006: ";
+    char *pos = dbgBuffer + 8;
+    for (uint8_t i = 0; i < PM1006_FRAME_LENGTH; i++) 
+    {
+      *pos++ = hexDigits[frame[i] >> 4];
+      *pos++ = hexDigits[frame[i] & 0x0F];
+    }
+    *pos = '\0';
+    log(MQTT_LEVEL_DEBUG, String(dbgBuffer), MQTT_LOG_PM1006);
   }
-  
-  /* Debug Print of received bytes */
-  String dbgBuffer = String("PM1006: ");
-  for (uint8_t i = 0; i < 20; i++) 
-  {
-    dbgBuffer += String(serialRxBuf[i], 16);
+
+  return pmFilter.getFiltered();
+}
+
+#ifdef VICTRON
+/** Names of the load output control values, must match MPPT_LOADCONTROL_FORMAT */
+static const char *const mLoadControlNames[] = { "off", "auto", "alt1", "alt2", "on" };
+#define MPPT_LOADCONTROL_COUNT  (sizeof(mLoadControlNames) / sizeof(mLoadControlNames[0]))
+
+bool mpptDebugHandler(uint8_t index, const HomieRange& range, const String& value) {
+  if (range.isRange) return false;
+
+  if (value.equals("true")) {
+    mppt[index]->activateDebugging(mqttLog_callback);
+  } else if (value.equals("false")) {
+    mppt[index]->activateDebugging(NULL);
+  } else {
+    return false;
   }
-  dbgBuffer += String("check: " + String(checksum, 16));
-  log(MQTT_LEVEL_DEBUG, String(dbgBuffer), MQTT_LOG_PM1006);
+  mpptNode[index]->setProperty(NODE_MPPT_DEBUG).send(value);
+  return true;
+}
 
-  // Header und Prüfsumme checken
-  if (serialRxBuf[0] == 0x16 && serialRxBuf[1] == 0x11 && serialRxBuf[2] == 0x0B /* && checksum == 0 */)
-  {
-    int pmValue = (serialRxBuf[5] << 8 | serialRxBuf[6]);
-    if (pmValue > PM_MAX) {
-      return (-1);
-    } else {
-      return pmValue;
+bool mpptLoadHandler(uint8_t index, const HomieRange& range, const String& value) {
+  if (range.isRange) return false;  // only one load output is present
+
+  for (unsigned int mode = 0; mode < MPPT_LOADCONTROL_COUNT; mode++) {
+    if (value.equals(mLoadControlNames[mode])) {
+      /* new state is published, as soon as the charger confirms it */
+      return mppt[index]->setLoadOutput(mode);
     }
   }
-  else
-  {
-    return (-1);
+  return false;
+}
+
+/**
+ * @brief Advertise all properties of one charger
+ * 
+ * @param index of the charger
+ */
+void mpptAdvertise(uint8_t index) {
+  HomieNode &node = *mpptNode[index];
+  HomieNode &solar = *solarNode[index];
+
+  node.advertise(NODE_MPPT).setName("MPPT")
+                              .setDatatype("json");
+  node.advertise(NODE_MPPT_GOODFRAMES).setName("Frames with valid checksum")
+                              .setDatatype("integer");
+  node.advertise(NODE_MPPT_BADFRAMES).setName("Frames with invalid checksum")
+                              .setDatatype("integer");
+  node.advertise(NODE_MPPT_TRUNCATEDFRAMES).setName("Incomplete frames")
+                              .setDatatype("integer");
+  node.advertise(NODE_MPPT_OVERLONGFIELDS).setName("Lines with too long label or value")
+                              .setDatatype("integer");
+  node.advertise(NODE_MPPT_UNKNOWNLABELS).setName("Lines with unknown label")
+                              .setDatatype("integer");
+  /* only the charger on the UART has a TX line for the HEX protocol, the others are received only */
+  if (index == 0) {
+    node.advertise(NODE_MPPT_HEXRESPONSES).setName("HEX responses")
+                                .setDatatype("integer");
+    node.advertise(NODE_MPPT_HEXTIMEOUTS).setName("HEX requests without response")
+                                .setDatatype("integer");
+    node.advertise(NODE_MPPT_HEXFAILURES).setName("HEX requests given up")
+                                .setDatatype("integer");
+    node.advertise(NODE_MPPT_HEXINVALID).setName("Invalid HEX frames")
+                                .setDatatype("integer");
+    node.advertise(NODE_MPPT_LOADCONTROL).setName("Load output")
+                                .setDatatype("enum").setFormat(MPPT_LOADCONTROL_FORMAT)
+                                .settable([index] (const HomieRange& range, const String& value) {
+                                  return mpptLoadHandler(index, range, value);
+                                });
   }
+  node.advertise(NODE_MPPT_DEBUG).setName("Log raw VE.Direct lines")
+                              .setDatatype("boolean")
+                              .settable([index] (const HomieRange& range, const String& value) {
+                                return mpptDebugHandler(index, range, value);
+                              });
+  node.advertise(NODE_MPPT_DEBUGDROPPED).setName("Raw lines, not logged completely")
+                              .setDatatype("integer");
+  solar.advertise(NODE_SOLAR).setName("Solar")
+                            .setDatatype("integer");
+
+  solar.advertise(NODE_SOLAR_BATTERYVOLT).setName("Solar")
+                            .setDatatype("integer").setUnit("mV");
+  solar.advertise(NODE_SOLAR_PANELPOWER).setName("Panel")
+                            .setDatatype("integer").setUnit("W");
+  solar.advertise(NODE_SOLAR_PANELVOLT).setName("Panel")
+                            .setDatatype("integer").setUnit("mV");
+  solar.advertise(NODE_SOLAR_BATTERYVOLT_MIN).setName("Battery minimum")
+                            .setDatatype("integer").setUnit("mV");
+  solar.advertise(NODE_SOLAR_BATTERYVOLT_MAX).setName("Battery maximum")
+                            .setDatatype("integer").setUnit("mV");
+  solar.advertise(NODE_SOLAR_BATTERYVOLT_MEAN).setName("Battery mean")
+                            .setDatatype("integer").setUnit("mV");
+  solar.advertise(NODE_SOLAR_BATTERYCURR_MIN).setName("Battery current minimum")
+                            .setDatatype("integer").setUnit("mA");
+  solar.advertise(NODE_SOLAR_BATTERYCURR_MAX).setName("Battery current maximum")
+                            .setDatatype("integer").setUnit("mA");
+  solar.advertise(NODE_SOLAR_BATTERYCURR_MEAN).setName("Battery current mean")
+                            .setDatatype("integer").setUnit("mA");
+  solar.advertise(NODE_SOLAR_PANELPOWER_MIN).setName("Panel minimum")
+                            .setDatatype("integer").setUnit("W");
+  solar.advertise(NODE_SOLAR_PANELPOWER_MAX).setName("Panel maximum")
+                            .setDatatype("integer").setUnit("W");
+  solar.advertise(NODE_SOLAR_PANELPOWER_MEAN).setName("Panel mean")
+                            .setDatatype("integer").setUnit("W");
+  solar.advertise(NODE_SOLAR_BATTERYENERGY).setName("Battery energy")
+                            .setDatatype("integer").setUnit("mWh");
+  solar.advertise(NODE_SOLAR_PANELENERGY).setName("Panel energy")
+                            .setDatatype("integer").setUnit("mWh");
+  solar.advertise(NODE_SOLAR_FRAMES).setName("Frames")
+                            .setDatatype("integer");
+}
+
+/**
+ * @brief Publish all values of one charger
+ * 
+ * @param index of the charger
+ */
+void mpptPublish(uint8_t index) {
+  victron::VictronComponent &charger = *mppt[index];
+  HomieNode &node = *mpptNode[index];
+  HomieNode &solar = *solarNode[index];
+  MpptPublish &published = mPublishMppt[index];
+
+  char json[VICTRON_JSON_MAX];
+  if (charger.toJson(json, sizeof(json)) > 0) {
+    publishText(node, NODE_MPPT, published.json, json);
+  } else {
+    LOG(MQTT_LEVEL_ERROR, F("MPPT JSON buffer too small"), MQTT_LOG_VICTRON);
+  }
+  publishCounter(node, NODE_MPPT_GOODFRAMES, published.goodFrames, charger.getGoodFrames());
+  publishCounter(node, NODE_MPPT_BADFRAMES, published.badFrames, charger.getBadFrames());
+  publishCounter(node, NODE_MPPT_TRUNCATEDFRAMES, published.truncatedFrames, charger.getTruncatedFrames());
+  publishCounter(node, NODE_MPPT_OVERLONGFIELDS, published.overlongFields, charger.getOverlongFields());
+  publishCounter(node, NODE_MPPT_UNKNOWNLABELS, published.unknownLabels, charger.getUnknownLabels());
+  if (index == 0) {
+    publishCounter(node, NODE_MPPT_HEXRESPONSES, published.hexResponses, charger.getHex().getResponses());
+    publishCounter(node, NODE_MPPT_HEXTIMEOUTS, published.hexTimeouts, charger.getHex().getTimeouts());
+    publishCounter(node, NODE_MPPT_HEXFAILURES, published.hexFailures, charger.getHex().getFailures());
+    publishCounter(node, NODE_MPPT_HEXINVALID, published.hexInvalid, charger.getHex().getInvalidFrames());
+    if ((charger.getLoadOutputControl() >= 0) && (charger.getLoadOutputControl() < (int) MPPT_LOADCONTROL_COUNT)) {
+      publishText(node, NODE_MPPT_LOADCONTROL, published.loadControl, mLoadControlNames[charger.getLoadOutputControl()]);
+    }
+  }
+  publishText(node, NODE_MPPT_DEBUG, published.debug, charger.isDebugging() ? "true" : "false");
+  publishCounter(node, NODE_MPPT_DEBUGDROPPED, published.debugDropped, charger.getDebugDropped());
+  /* answer is received in the background and published with the next cycle */
+  if (index == 0) {
+    charger.requestRegister(VICTRON_REG_LOAD_OUTPUT_CONTROL);
+  }
+  publishNumber(solar, NODE_SOLAR_BATTERYVOLT, published.batteryVoltage, charger.getBatteryMillivolt());
+  publishNumber(solar, NODE_SOLAR_PANELVOLT, published.panelVoltage, charger.getPanelMillivolt());
+  publishNumber(solar, NODE_SOLAR_PANELPOWER, published.panelPower, charger.getPanelPower());
+  /* Statistic of all frames since the last cycle */
+  const victron::VictronWindow &window = charger.getWindow();
+  if (window.frames > 0) {
+    publishNumber(solar, NODE_SOLAR_BATTERYVOLT_MIN, published.batteryVoltageMin, window.battery_voltage.min);
+    publishNumber(solar, NODE_SOLAR_BATTERYVOLT_MAX, published.batteryVoltageMax, window.battery_voltage.max);
+    publishNumber(solar, NODE_SOLAR_BATTERYVOLT_MEAN, published.batteryVoltageMean, window.battery_voltage.mean());
+    publishNumber(solar, NODE_SOLAR_BATTERYCURR_MIN, published.batteryCurrentMin, window.battery_current.min);
+    publishNumber(solar, NODE_SOLAR_BATTERYCURR_MAX, published.batteryCurrentMax, window.battery_current.max);
+    publishNumber(solar, NODE_SOLAR_BATTERYCURR_MEAN, published.batteryCurrentMean, window.battery_current.mean());
+    publishNumber(solar, NODE_SOLAR_PANELPOWER_MIN, published.panelPowerMin, window.panel_power.min);
+    publishNumber(solar, NODE_SOLAR_PANELPOWER_MAX, published.panelPowerMax, window.panel_power.max);
+    publishNumber(solar, NODE_SOLAR_PANELPOWER_MEAN, published.panelPowerMean, window.panel_power.mean());
+    publishNumber(solar, NODE_SOLAR_BATTERYENERGY, published.batteryEnergy, window.batteryEnergy());
+    publishNumber(solar, NODE_SOLAR_PANELENERGY, published.panelEnergy, window.panelEnergy());
+  }
+  publishNumber(solar, NODE_SOLAR_FRAMES, published.frames, window.frames);
+  charger.resetWindow();
+}
+
+#if VICTRON_COUNT > 1
+/**
+ * @brief Publish the sum of all chargers
+ */
+void mpptPublishTotals() {
+  long power = 0;
+  long yieldToday = 0;
+  long yieldTotal = 0;
+  char number[FORMAT_NUMBER_MAX];
+  for (uint8_t i = 0; i < VICTRON_COUNT; i++) {
+    power += mppt[i]->getPanelPower();
+    yieldToday += mppt[i]->getYieldToday();
+    yieldTotal += mppt[i]->getYieldTotal();
+  }
+  if (mPublishTotalPower.check(power)) {
+    solarTotalNode.setProperty(NODE_SOLAR_PANELPOWER).send(formatNumber(number, power));
+  }
+  if (mPublishTotalYield.check(yieldToday + yieldTotal)) {
+    solarTotalNode.setProperty(NODE_SOLAR_YIELD_TODAY).send(formatNumber(number, yieldToday));
+    solarTotalNode.setProperty(NODE_SOLAR_YIELD_TOTAL).send(formatNumber(number, yieldTotal));
+  }
+}
+#endif
+
+/**
+ * @brief Check all chargers for received values
+ */
+bool mpptHasData() {
+  for (uint8_t i = 0; i < VICTRON_COUNT; i++) {
+    if (!mppt[i]->hasData()) {
+      return false;
+    }
+  }
+  return true;
 }
+#endif
 
 /**
  * @brief Handle events of the Homie platform
@@ -238,16 +717,22 @@ void onHomieEvent(const HomieEvent &event)
       }
     break;
   case HomieEventType::MQTT_READY:
-    mConnected=true;
+    logConnected();
 #ifdef VICTRON
-    mppt.activateDebugging(mqttLog_callback);
+    if (debugMppt.get()) {
+      for (uint8_t i = 0; i < VICTRON_COUNT; i++) {
+        mppt[i]->activateDebugging(mqttLog_callback);
+      }
+    }
 #endif
     digitalWrite(WITTY_RGB_R, LOW);
     if (!i2cEnable.get()) { /** keep green LED activated to power I2C sensor */
       digitalWrite(WITTY_RGB_G, LOW);
-      log(MQTT_LEVEL_INFO, F("I2C powersupply deactivated"), MQTT_LOG_I2CINIT);
+      LOG(MQTT_LEVEL_INFO, F("I2C powersupply deactivated"), MQTT_LOG_I2CINIT);
+    }
+    if (mBlueLed) {
+      digitalWrite(WITTY_RGB_B, LOW);
     }
-    digitalWrite(WITTY_RGB_B, LOW);
     /* Update LED only, if not sleeping */
     if (deepsleep.get() <= 0) {
       strip.fill(strip.Color(0,0,PERCENT2FACTOR(127, rgbDim)));
@@ -255,19 +740,19 @@ void onHomieEvent(const HomieEvent &event)
     }
 
     if (mFailedI2Cinitialization) {
-      log(MQTT_LEVEL_DEBUG, 
+      /* no preprocessor directives in the arguments of the macro */
 #ifdef BME680
-    "Could not find a valid BME680 sensor, check wiring or try a different address!"
+      static const char notFound[] = "Could not find a valid BME680 sensor, check wiring or try a different address!";
 #else
 #ifdef BMP280
-    "Could not find a valid BMP280 sensor, check wiring or try a different address!"
+      static const char notFound[] = "Could not find a valid BMP280 sensor, check wiring or try a different address!";
 #else
-  "no I2C sensor defined"
+      static const char notFound[] = "no I2C sensor defined";
 #endif
 #endif
-      , MQTT_LOG_I2CINIT);
+      LOG(MQTT_LEVEL_DEBUG, notFound, MQTT_LOG_I2CINIT);
     } else {
-      log(MQTT_LEVEL_INFO, F("BME680 sensor found"), MQTT_LOG_I2CINIT);
+      LOG(MQTT_LEVEL_INFO, F("BME680 sensor found"), MQTT_LOG_I2CINIT);
     }
     break;
   case HomieEventType::OTA_STARTED:
@@ -277,35 +762,248 @@ void onHomieEvent(const HomieEvent &event)
     ESP.restart();
     break;
   case HomieEventType::WIFI_CONNECTED:
-    digitalWrite(WITTY_RGB_B, HIGH);
+    if (mBlueLed) {
+      digitalWrite(WITTY_RGB_B, HIGH);
+    }
     break;
   default:
     break;
   }
 }
 
-void bmpPublishValues() {
+/**
+ * @brief Parse a comma separated list of numbers (e.g. "30,,2.5") into the given values
+ * Empty or missing entries keep the value.
+ * @return false, if the text contains something else than numbers or more than count entries
+ */
+bool parseList(const char *text, double *values, uint8_t count) {
+  uint8_t index = 0;
+  while (*text) {
+    if (index >= count) {
+      return false;
+    }
+    if (*text != ',') {
+      char *end;
+      double value = strtod(text, &end);
+      if (end == text) {
+        return false;
+      }
+      values[index] = value;
+      text = end;
+    }
+    if (*text == ',') {
+      text++;
+      index++;
+    } else if (*text) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Check an integer value of a list setting
+ */
+bool settingInRange(double value, long minimum, long maximum) {
+  return (value == (long) value) && (value >= minimum) && (value <= maximum);
+}
+
+/**
+ * @brief Oversampling factor 1, 2, 4, 8 or 16; 0 (skipped) if allowed
+ */
+bool settingOversampling(double value, bool skip) {
+  long factor = (long) value;
+  return settingInRange(value, skip ? 0 : 1, 16) && ((factor & (factor - 1)) == 0);
+}
+
+bool bmxSettingsValid(const double *values) {
+  long coefficient = (long) values[BMX_IIR];
+#ifdef BME680
+  /* 0, 1, 3, 7, 15, 31, 63 or 127 */
+  bool filter = settingInRange(values[BMX_IIR], 0, 127) && (((coefficient + 1) & coefficient) == 0);
+#else
+  /* 0, 2, 4, 8 or 16 */
+  bool filter = settingInRange(values[BMX_IIR], 0, 16) && (coefficient != 1) && ((coefficient & (coefficient - 1)) == 0);
+#endif
+  return filter && settingOversampling(values[BMX_OS_TEMPERATURE], false) &&
+         settingOversampling(values[BMX_OS_PRESSURE], true) && settingOversampling(values[BMX_OS_HUMIDITY], true);
+}
+
+bool publishSettingsValid(const double *values) {
+  for (uint8_t i = PUBLISH_TEMPERATURE; i < PUBLISH_SETTINGS; i++) {
+    if (values[i] < 0) {
+      return false;
+    }
+  }
+  return settingInRange(values[PUBLISH_HEARTBEAT], 1, 86400);
+}
+
+bool scheduleSettingsValid(const double *values) {
+  for (uint8_t i = 0; i < SCHEDULE_SETTINGS; i += 2) {
+    if (!settingInRange(values[i], 1, 86400) || !settingInRange(values[i + 1], 0, 86400)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Register value of an oversampling factor (0 skipped, 1, 2, 4, 8 or 16); the same for both sensors
+ */
+uint8_t bmpOversampling(long factor) {
+  uint8_t value = 0;
+  while ((factor > 0) && (value < 5)) {
+    factor >>= 1;
+    value++;
+  }
+  return value;
+}
+
+/**
+ * @brief Register value of the IIR filter coefficient
+ * BME680: 0, 1, 3, 7, 15, 31, 63 or 127; BMP280: 0, 2, 4, 8 or 16
+ */
+uint8_t bmpFilter(long coefficient) {
+  uint8_t value = 0;
+#ifdef BME680
+  coefficient++;
+#endif
+  while (coefficient > 1) {
+    coefficient >>= 1;
+    value++;
+  }
+  return value;
+}
+
+/**
+ * @brief Configure the sensor for single measurements, started by bmpStartMeasurement()
+ */
+void bmpConfigure() {
+#ifdef BME680
+  bmx.setTemperatureOversampling(bmpOversampling((long) mBmxSettings[BMX_OS_TEMPERATURE]));
+  bmx.setHumidityOversampling(bmpOversampling((long) mBmxSettings[BMX_OS_HUMIDITY]));
+  bmx.setPressureOversampling(bmpOversampling((long) mBmxSettings[BMX_OS_PRESSURE]));
+  bmx.setIIRFilterSize(bmpFilter((long) mBmxSettings[BMX_IIR]));
+  bmx.setGasHeater(320, 150); // 320*C for 150 ms
+  mBmxConversion = BMX_DURATION_BME680;
+#endif
+#ifdef BMP280
+  /* Sleep between the forced measurements; measurement time according datasheet: 1.25 ms + 2.3 ms per oversampling + 0.575 ms */
+  bmx.setSampling(Adafruit_BMP280::MODE_SLEEP,
+                  (Adafruit_BMP280::sensor_sampling) bmpOversampling((long) mBmxSettings[BMX_OS_TEMPERATURE]),
+                  (Adafruit_BMP280::sensor_sampling) bmpOversampling((long) mBmxSettings[BMX_OS_PRESSURE]),
+                  (Adafruit_BMP280::sensor_filter) bmpFilter((long) mBmxSettings[BMX_IIR]));
+  mBmxConversion = ((1250 + 2300 * ((long) mBmxSettings[BMX_OS_TEMPERATURE] + (long) mBmxSettings[BMX_OS_PRESSURE]) + 575) / 1000) + 1;
+#endif
+}
+
+/**
+ * @brief Start one forced measurement of the BOSCH sensor, the result is collected by bmpLoop()
+ */
+void bmpStartMeasurement() {
 #ifdef BME680
   // Tell BME680 to begin measurement.
   unsigned long endTime = bmx.beginReading();
   if (endTime == 0) {
-    log(MQTT_LEVEL_ERROR, "BMX not accessible", MQTT_LOG_I2READ);
+    LOG(MQTT_LEVEL_ERROR, F("BMX not accessible"), MQTT_LOG_I2READ);
+    return;
+  }
+#endif
+#ifdef BMP280
+  /* Writing the forced mode starts one measurement, afterwards the sensor sleeps again */
+  bmx.setSampling(Adafruit_BMP280::MODE_FORCED,
+                  (Adafruit_BMP280::sensor_sampling) bmpOversampling((long) mBmxSettings[BMX_OS_TEMPERATURE]),
+                  (Adafruit_BMP280::sensor_sampling) bmpOversampling((long) mBmxSettings[BMX_OS_PRESSURE]),
+                  (Adafruit_BMP280::sensor_filter) bmpFilter((long) mBmxSettings[BMX_IIR]));
+#endif
+  mBmxStarted = millis();
+  mBmxMeasuring = true;
+}
+
+/**
+ * @brief Check, if the started measurement is finished
+ */
+bool bmpFinished() {
+#ifdef BME680
+  return (bmx.remainingReadingMillis() == 0);
+#else
+  /* status bit 3: conversion is running */
+  return ((millis() - mBmxStarted) >= mBmxConversion) && ((bmx.getStatus() & 0x08) == 0);
+#endif
+}
+
+/**
+ * @brief Read the result of the measurement once into the snapshot
+ * The libraries deliver floats; they are converted once into scaled integers.
+ */
+void bmpCollect() {
+  mBmxMeasuring = false;
+#ifdef BME680
+  /* Waits only, if the measurement is not finished yet */
+  if (!bmx.endReading()) {
+    LOG(MQTT_LEVEL_ERROR, F("BMX reading failed"), MQTT_LOG_I2READ);
     return;
   }
+  mBmx.temperature = lroundf(bmx.temperature * 100);
+  mBmx.pressure = bmx.pressure;
+  mBmx.humidity = lroundf(bmx.humidity * 100);
+  mBmx.gas = bmx.gas_resistance;
+  mBmx.iaq = mIaq.update(mBmx.gas, mBmx.humidity);
+#else
+  while (!bmpFinished() && ((millis() - mBmxStarted) < BMX_DURATION_MAX)) {
+    delay(1);
+  }
+  mBmx.temperature = lroundf(bmx.readTemperature() * 100);
+  mBmx.pressure = lroundf(bmx.readPressure());
 #endif
+  /* same result as readAltitude() of the Adafruit libraries, without a further measurement */
+  mBmx.altitude = altitudeFromPressure(mBmx.pressure);
+  mBmxFinished = millis();
+  /* only reported: collecting later than the conversion must not delay the next start */
+  mBmxDuration = mBmxFinished - mBmxStarted;
+  mBmxValid = true;
+}
+
+/**
+ * @brief Publish the latest snapshot
+ * 
+ * @param due time of the publish cycle, to report the latency of the measurement
+ */
+void bmpPublishValues(unsigned long due) {
+  char number[FORMAT_NUMBER_MAX];
+  mBmxValid = false;
   //  Publish the values
-  temperaturNode.setProperty(NODE_TEMPERATUR).send(String(bmx.readTemperature()));
-  pressureNode.setProperty(NODE_PRESSURE).send(String(bmx.readPressure() / 100.0F));
-  altitudeNode.setProperty(NODE_ALTITUDE).send(String(bmx.readAltitude(SEALEVELPRESSURE_HPA)));
+  if (mPublishTemperature.check(mBmx.temperature)) {
+    temperaturNode.setProperty(NODE_TEMPERATUR).send(formatScaled(number, mBmx.temperature, 2, DECIMALS_TEMPERATURE));
+  }
+  if (mPublishPressure.check(mBmx.pressure)) {
+    pressureNode.setProperty(NODE_PRESSURE).send(formatScaled(number, mBmx.pressure, 2, DECIMALS_PRESSURE));
+  }
+  if (mPublishAltitude.check(mBmx.altitude)) {
+    altitudeNode.setProperty(NODE_ALTITUDE).send(formatScaled(number, mBmx.altitude, 2, DECIMALS_ALTITUDE));
+  }
 #ifdef BME680
-  gasNode.setProperty(NODE_GAS).send(String((bmx.gas_resistance / 1000.0)));
-  humidityNode.setProperty(NODE_HUMIDITY).send(String(bmx.humidity));
+  if (mPublishGas.check(mBmx.gas)) {
+    gasNode.setProperty(NODE_GAS).send(formatScaled(number, mBmx.gas, 3, DECIMALS_GAS));
+  }
+  if ((mBmx.iaq >= 0) && mPublishIaq.check(mBmx.iaq)) {
+    gasNode.setProperty(NODE_GAS_IAQ).send(formatNumber(number, mBmx.iaq));
+  }
+  if (mPublishBaseline.check(mIaq.getBaseline())) {
+    gasNode.setProperty(NODE_GAS_BASELINE).send(formatScaled(number, mIaq.getBaseline(), 3, DECIMALS_GAS));
+  }
+  if (mPublishHumidity.check(mBmx.humidity)) {
+    humidityNode.setProperty(NODE_HUMIDITY).send(formatScaled(number, mBmx.humidity, 2, DECIMALS_HUMIDITY));
+  }
 #endif
-  log(MQTT_LEVEL_DEBUG, String("Temp" + String(bmx.readTemperature()) + "\tPressure:" +
-      String(bmx.readPressure() / 100.0F) + "\t Altitude:"+
-      String(bmx.readAltitude(SEALEVELPRESSURE_HPA))), MQTT_LOG_I2READ);
+  /* Time, the values were later available than needed */
+  publishNumber(temperaturNode, NODE_BMX_LATENCY, mPublishBmxLatency, ((long) (mBmxFinished - due) > 0) ? (long) (mBmxFinished - due) : 0);
+  publishCounter(temperaturNode, NODE_BMX_DURATION, mPublishBmxDuration, mBmxDuration);
+  LOG(MQTT_LEVEL_DEBUG, String("Temp[0.01C]:" + String(mBmx.temperature) + "\tPressure[Pa]:" +
+      String(mBmx.pressure) + "\t Altitude[cm]:"+
+      String(mBmx.altitude)), MQTT_LOG_I2READ);
   if ( (rgbTemp.get()) && (!mSomethingReceived) ) {
-      if (bmx.readTemperature() < TEMPBORDER) {
+      if (mBmx.temperature < (TEMPBORDER * 100)) {
         strip.setPixelColor(0, strip.Color(0,0,PERCENT2FACTOR(127, rgbDim)));
       } else {
         strip.setPixelColor(0, strip.Color(PERCENT2FACTOR(127, rgbDim),0,0));
@@ -314,71 +1012,174 @@ void bmpPublishValues() {
   }
 }
 
-
 /**
- * @brief Main loop, triggered by the Homie API
- * All logic needs to be done here.
- * 
- * The ranges are defined as followed:
- * - green: 0-35 (good+low)
- * - orange: 36-85 (OK+medicore)
- * - red: 86-... (bad+high)
+ * @brief Schedule the BOSCH sensor: the measurement is started, so that it is finished at the next publish
  * 
- * source @link{https://github.com/Hypfer/esp8266-vindriktning-particle-sensor/issues/16#issuecomment-903116056}
+ * @param due time of the next publish cycle
  */
-void loopHandler()
+void bmpLoop(unsigned long due) {
+  if (!i2cEnable.get() || mFailedI2Cinitialization) {
+    return;
+  }
+  if (mBmxMeasuring) {
+    if (bmpFinished()) {
+      bmpCollect();
+    }
+  } else if (!mBmxValid && ((long) (due - millis()) <= (long) (mBmxConversion + BMX_DURATION_MARGIN))) {
+    bmpStartMeasurement();
+  }
+}
+
+
+/**
+ * @brief Publish the particle values, filtered since the last publish
+ */
+void taskParticle()
 {
-  static long lastRead = 0;
-  if ((millis() - lastRead) > PM1006_MQTT_UPDATE) {
-    mParticle_pM25 = getSensorData();
-    if (mParticle_pM25 >= 0) {
-        particle.setProperty(NODE_PARTICLE).send(String(mParticle_pM25));
-      if (!mSomethingReceived) {
-        if (mParticle_pM25 < 35) {
-          strip.fill(strip.Color(0, PERCENT2FACTOR(127, rgbDim), 0)); /* green */
-        } else if (mParticle_pM25 < 85) {
-          strip.fill(strip.Color(PERCENT2FACTOR(127, rgbDim), PERCENT2FACTOR(64, rgbDim), 0)); /* orange */
-        } else {
-          strip.fill(strip.Color(PERCENT2FACTOR(127, rgbDim), 0, 0)); /* red */
-        }
-        strip.show();
+  char number[FORMAT_NUMBER_MAX];
+  mParticle_pM25 = getSensorData();
+  if (mParticle_pM25 >= 0) {
+    if (mPublishParticle.check(mParticle_pM25)) {
+      particle.setProperty(NODE_PARTICLE).send(formatNumber(number, mParticle_pM25));
+    }
+    publishNumber(particle, NODE_PARTICLE_RAW, mPublishRaw, pmFilter.getRaw());
+    if (!mSomethingReceived) {
+      if (mParticle_pM25 < 35) {
+        strip.fill(strip.Color(0, PERCENT2FACTOR(127, rgbDim), 0)); /* green */
+      } else if (mParticle_pM25 < 85) {
+        strip.fill(strip.Color(PERCENT2FACTOR(127, rgbDim), PERCENT2FACTOR(64, rgbDim), 0)); /* orange */
+      } else {
+        strip.fill(strip.Color(PERCENT2FACTOR(127, rgbDim), 0, 0)); /* red */
       }
+      strip.show();
     }
+  }
 
-    /* Read BOSCH sensor */
-    if (i2cEnable.get() && (!mFailedI2Cinitialization)) {
-      bmpPublishValues();
-    }
+  if (pmFilter.getWindowSamples() > 0) {
+    PM1006Frame frame = pm1006.getFrame();
+    /* Further values of the latest frame, with the deadband of the particles; each change of the status */
+    publishNumber(particle, NODE_PARTICLE_PM1, mPublishPm1, frame.getPM1());
+    publishNumber(particle, NODE_PARTICLE_PM10, mPublishPm10, frame.getPM10());
+    publishText(particle, NODE_PARTICLE_STATUS, mPublishStatus, formatUnsigned(number, frame.getStatus(), 16));
+  }
+  publishNumber(particle, NODE_PARTICLE_SAMPLES, mPublishSamples, pmFilter.getWindowSamples());
+  pmFilter.resetWindow();
 
-    mMeasureIndex++;
+  /* Quality of the link to the particle sensor, with the heartbeat */
+  publishCounter(particle, NODE_PARTICLE_GOODFRAMES, mPublishParticleGood, pm1006.getGoodFrames());
+  publishCounter(particle, NODE_PARTICLE_BADFRAMES, mPublishParticleBad, pm1006.getBadFrames());
+  publishCounter(particle, NODE_PARTICLE_RESYNCS, mPublishParticleResyncs, pm1006.getResyncs());
+  publishCounter(particle, NODE_PARTICLE_OVERFLOWS, mPublishParticleOverflows, mParticleOverflows);
+  publishCounter(particle, NODE_PARTICLE_REJECTED, mPublishParticleRejected, pmFilter.getRejected());
+}
 
-    /* Clean cycles buttons */
-    if (mButtonPressed <= BUTTON_MIN_ACTION_CYCLE) {
-      buttonNode.setProperty(NODE_BUTTON).send("0");
+/**
+ * @brief Publish the BOSCH values: the measurement was started before, so that it is finished now
+ */
+void taskBmx()
+{
+  static unsigned long due = 0;
+  if (i2cEnable.get() && (!mFailedI2Cinitialization)) {
+    if (!mBmxMeasuring && !mBmxValid) {
+      bmpStartMeasurement();
+    }
+    if (mBmxMeasuring) {
+      bmpCollect();
+    }
+    if (mBmxValid) {
+      bmpPublishValues((due != 0) ? due : millis());
     }
-    lastRead = millis();
+  }
+  due = mScheduler.getNextRun(mTaskBmx);
+}
 
-    /* If nothing needs to be done, sleep and the time is ready for sleeping */
-    if ((mMeasureIndex > MIN_MEASURED_CYCLES) && (deepsleep.get() > 0) 
 #ifdef VICTRON
-    && (mppt.hasData() || (deepsleepMppt.get() == 0))
+void taskMppt()
+{
+  for (uint8_t i = 0; i < VICTRON_COUNT; i++) {
+    mpptPublish(i);
+  }
+#if VICTRON_COUNT > 1
+  mpptPublishTotals();
+#endif
+#ifdef VICTRON_CAPTURE
+  /* throughput since the start of the replay, not since the boot */
+  uint32_t replayed = mpptReplay.getDuration();
+  if (replayed >= 1000) {
+    LOG(MQTT_LEVEL_INFO, String("Replay: ") + String((uint32_t) (((uint64_t) mppt[0]->getGoodFrames() * 1000) / replayed)) + " frames/s " +
+        String((uint32_t) (((uint64_t) mppt[0]->getBytesReceived() * 1000) / replayed)) + " bytes/s", MQTT_LOG_VICTRON);
+  }
+#endif
+}
 #endif
-    ) {
-      Homie.prepareToSleep();
-      delay(100);
-    }
-#ifdef VICTRON
-    mpptNode.setProperty(NODE_MPPT).send(mppt.toJson());
-    solarNode.setProperty(NODE_SOLAR_BATTERYVOLT).send(String(mppt.getBatteryVoltage()));
-    solarNode.setProperty(NODE_SOLAR_PANELVOLT).send(String(mppt.getPanelVoltage()));
-    solarNode.setProperty(NODE_SOLAR_PANELPOWER).send(String(mppt.getPanelPower()));
 
+/**
+ * @brief End of one measurement cycle: statistics and deep sleep
+ */
+void taskCycle()
+{
+  char number[FORMAT_NUMBER_MAX];
+  mMeasureIndex++;
+
+  /* Savings of the deadbands, reported with the heartbeat */
+  static unsigned long lastStatistic = 0;
+  if ((lastStatistic == 0) || ((millis() - lastStatistic) >= Deadband::getHeartbeat())) {
+    lastStatistic = millis();
+    publishNode.setProperty(NODE_PUBLISH_SENT).send(formatUnsigned(number, Deadband::getSent()));
+    publishNode.setProperty(NODE_PUBLISH_SUPPRESSED).send(formatUnsigned(number, Deadband::getSuppressed()));
+    publishNode.setProperty(NODE_PUBLISH_OVERRUNS).send(formatUnsigned(number, mScheduler.getOverruns()));
+    publishNode.setProperty(NODE_PUBLISH_LOGDROPPED).send(formatUnsigned(number, logDropped()));
+    publishNode.setProperty(NODE_PUBLISH_LOGSUPPRESSED).send(formatUnsigned(number, logSuppressed()));
+    publishNode.setProperty(NODE_PUBLISH_LOGBATCHES).send(formatUnsigned(number, logBatches()));
+  }
+
+  /* Clean cycles buttons */
+  if ((mButtonPressed <= BUTTON_MIN_ACTION_CYCLE) && mPublishButton.check(0L)) {
+    buttonNode.setProperty(NODE_BUTTON).send("0");
+  }
+
+  /* If nothing needs to be done, sleep and the time is ready for sleeping */
+  if ((mMeasureIndex > MIN_MEASURED_CYCLES) && (deepsleep.get() > 0) 
+#ifdef VICTRON
+  && (mpptHasData() || (deepsleepMppt.get() == 0))
 #endif
+  ) {
+    logFlush();
+    Homie.prepareToSleep();
+    delay(100);
   }
+}
+
+/**
+ * @brief A task needed longer than its budget
+ * The text is the same for each overrun of a task, so the repeats are limited by the log; all are counted by the scheduler.
+ */
+void taskOverrun(const char *name, uint32_t, uint32_t budget)
+{
+  LOG(MQTT_LEVEL_WARNING, String("Task ") + name + " exceeded its budget of " + String(budget) + " ms", MQTT_LOG_SCHEDULER);
+}
+
+/**
+ * @brief Main loop, triggered by the Homie API
+ * All logic needs to be done here.
+ * 
+ * The ranges are defined as followed:
+ * - green: 0-35 (good+low)
+ * - orange: 36-85 (OK+medicore)
+ * - red: 86-... (bad+high)
+ * 
+ * source @link{https://github.com/Hypfer/esp8266-vindriktning-particle-sensor/issues/16#issuecomment-903116056}
+ */
+void loopHandler()
+{
+  char number[FORMAT_NUMBER_MAX];
+  bmpLoop(mScheduler.getNextRun(mTaskBmx));
+  /* each sensor is published by its own task; only one task per loop */
+  mScheduler.loop();
 
   /* if the user sees something via the LEDs, inform MQTT, too */
-  if (mButtonPressed > BUTTON_MIN_ACTION_CYCLE) {
-    buttonNode.setProperty(NODE_BUTTON).send(String(mButtonPressed));
+  if ((mButtonPressed > BUTTON_MIN_ACTION_CYCLE) && mPublishButton.check(mButtonPressed)) {
+    buttonNode.setProperty(NODE_BUTTON).send(formatUnsigned(number, mButtonPressed));
   }
 
   // Feed the dog -> ESP stay alive
@@ -426,38 +1227,140 @@ bool ledHandler(const HomieRange& range, const String& value) {
 
 void setup()
 { 
+  logSetup();
   SPIFFS.begin();
   Serial.begin(SERIAL_BAUDRATE);
   Serial.setTimeout(2000);
 
   pinMode(WITTY_RGB_R, OUTPUT);
   pinMode(WITTY_RGB_G, OUTPUT);
-  pinMode(WITTY_RGB_B, OUTPUT);
   digitalWrite(WITTY_RGB_R, LOW);
   digitalWrite(WITTY_RGB_G, LOW);
-  digitalWrite(WITTY_RGB_B, LOW);
+  if (mBlueLed) {
+    pinMode(WITTY_RGB_B, OUTPUT);
+    digitalWrite(WITTY_RGB_B, LOW);
+  }
     
   Homie_setFirmware(HOMIE_FIRMWARE_NAME, HOMIE_FIRMWARE_VERSION);
+#ifdef VICTRON
+  /* TX of the UART is connected to the charger (VE.Direct HEX protocol) */
+  Homie.disableLogging();
+#endif
   Homie.setLoopFunction(loopHandler);
   Homie.onEvent(onHomieEvent);
   i2cEnable.setDefaultValue(false);
 #if VICTRON
   deepsleepMppt.setDefaultValue(false);
+  debugMppt.setDefaultValue(false);
 #endif
   rgbTemp.setDefaultValue(false);
-
+  /* the defaults are in mBmxSettings, mPublishSettings and mScheduleSettings */
+  bmxSetting.setDefaultValue("").setValidator([] (const char *candidate) {
+    double values[BMX_SETTINGS];
+    memcpy(values, mBmxSettings, sizeof(values));
+    return parseList(candidate, values, BMX_SETTINGS) && bmxSettingsValid(values);
+  });
+  publishSetting.setDefaultValue("").setValidator([] (const char *candidate) {
+    double values[PUBLISH_SETTINGS];
+    memcpy(values, mPublishSettings, sizeof(values));
+    return parseList(candidate, values, PUBLISH_SETTINGS) && publishSettingsValid(values);
+  });
+  scheduleSetting.setDefaultValue("").setValidator([] (const char *candidate) {
+    double values[SCHEDULE_SETTINGS];
+    memcpy(values, mScheduleSettings, sizeof(values));
+    return parseList(candidate, values, SCHEDULE_SETTINGS) && scheduleSettingsValid(values);
+  });
   rgbDim.setDefaultValue(100).setValidator([] (long candidate) {
     return (candidate > 1) && (candidate <= 200);
   });
+  logLevel.setDefaultValue(MQTT_LEVEL_DEBUG).setValidator([] (long candidate) {
+    return (candidate >= 0) && (candidate <= MQTT_LEVEL_DEBUG);
+  });
   deepsleep.setDefaultValue(0).setValidator([] (long candidate) {
       return ((candidate >= 0) && (candidate < 4294)); /* between 0 (deactivated) and 71 minutes */
   });
-  memset(serialRxBuf, 0, SERIAL_RCEVBUF_MAX);
+#ifdef VICTRON
+#ifdef VICTRON_CAPTURE
+  mpptCapture = SPIFFS.open(VICTRON_CAPTURE, "r");
+  mppt[0] = new victron::VictronComponent(mpptReplay);
+#else
+  mppt[0] = new victron::VictronComponent(Serial);
+#endif
+  for (uint8_t i = 0; i < VICTRON_COUNT; i++) {
+#if VICTRON_COUNT > 1
+    if (i > 0) {
+      /* receive only: no TX pin is left for the HEX protocol */
+      SoftwareSerial *uart = new SoftwareSerial(mMpptRxPins[i - 1], -1);
+      uart->begin(SERIAL_BAUDRATE, SWSERIAL_8N1, mMpptRxPins[i - 1], -1, false, VICTRON_RX_BUFFER);
+      mppt[i] = new victron::VictronComponent(*uart);
+    }
+#endif
+    mpptNode[i] = new HomieNode(mMpptNodeIds[i], "MPPT", "json");
+    solarNode[i] = new HomieNode(mSolarNodeIds[i], "Solar", "number");
+  }
+#endif
 
   pmSerial.begin(PM1006_BIT_RATE);
   Homie.setup();
+  mLogLevel = logLevel.get();
+  parseList(bmxSetting.get(), mBmxSettings, BMX_SETTINGS);
+  parseList(publishSetting.get(), mPublishSettings, PUBLISH_SETTINGS);
+  parseList(scheduleSetting.get(), mScheduleSettings, SCHEDULE_SETTINGS);
+  Deadband::setHeartbeat(lround(mPublishSettings[PUBLISH_HEARTBEAT] * 1000));
+  /* the settings are given in the published units, the values are scaled integers */
+  mPublishTemperature.setWidth(lround(mPublishSettings[PUBLISH_TEMPERATURE] * 100));
+  mPublishPressure.setWidth(lround(mPublishSettings[PUBLISH_PRESSURE] * 100));
+  mPublishParticle.setWidth(lround(mPublishSettings[PUBLISH_PARTICLE]));
+  mPublishRaw.setWidth(lround(mPublishSettings[PUBLISH_PARTICLE]));
+  mPublishPm1.setWidth(lround(mPublishSettings[PUBLISH_PARTICLE]));
+  mPublishPm10.setWidth(lround(mPublishSettings[PUBLISH_PARTICLE]));
+#ifdef BME680
+  mPublishHumidity.setWidth(lround(mPublishSettings[PUBLISH_HUMIDITY] * 100));
+  mPublishGas.setWidth(lround(mPublishSettings[PUBLISH_GAS] * 1000));
+#endif
+#ifdef VICTRON
+  for (uint8_t i = 0; i < VICTRON_COUNT; i++) {
+    mPublishMppt[i].panelPower.setWidth(lround(mPublishSettings[PUBLISH_POWER]));
+    mPublishMppt[i].panelPowerMin.setWidth(lround(mPublishSettings[PUBLISH_POWER]));
+    mPublishMppt[i].panelPowerMax.setWidth(lround(mPublishSettings[PUBLISH_POWER]));
+    mPublishMppt[i].panelPowerMean.setWidth(lround(mPublishSettings[PUBLISH_POWER]));
+  }
+#if VICTRON_COUNT > 1
+  mPublishTotalPower.setWidth(lround(mPublishSettings[PUBLISH_POWER]));
+#endif
+#endif
+
+  /* Each sensor has its own period; the phases spread the publishes over the period */
+  const unsigned long particlePeriod = (unsigned long) (mScheduleSettings[SCHEDULE_PARTICLE_PERIOD] * 1000);
+  const unsigned long particlePhase = (unsigned long) (mScheduleSettings[SCHEDULE_PARTICLE_PHASE] * 1000);
+  const unsigned long bmxPeriod = (unsigned long) (mScheduleSettings[SCHEDULE_BMX_PERIOD] * 1000);
+  const unsigned long bmxPhase = (unsigned long) (mScheduleSettings[SCHEDULE_BMX_PHASE] * 1000);
+  unsigned long lastPhase = max(particlePhase, bmxPhase);
+  /* the cycle follows the slowest sensor, so each one is published before the deep sleep */
+  unsigned long cyclePeriod = max(particlePeriod, bmxPeriod);
+  mScheduler.add("particle", taskParticle, particlePeriod, particlePhase, TASK_BUDGET_PARTICLE);
+  mTaskBmx = mScheduler.add("bmx", taskBmx, bmxPeriod, bmxPhase, TASK_BUDGET_BMX);
+#ifdef VICTRON
+  const unsigned long mpptPeriod = (unsigned long) (mScheduleSettings[SCHEDULE_MPPT_PERIOD] * 1000);
+  const unsigned long mpptPhase = (unsigned long) (mScheduleSettings[SCHEDULE_MPPT_PHASE] * 1000);
+  mScheduler.add("mppt", taskMppt, mpptPeriod, mpptPhase, TASK_BUDGET_MPPT);
+  lastPhase = max(lastPhase, mpptPhase);
+  cyclePeriod = max(cyclePeriod, mpptPeriod);
+#endif
+  mScheduler.add("cycle", taskCycle, cyclePeriod, lastPhase + TASK_CYCLE_DELAY, TASK_BUDGET_CYCLE);
+  mScheduler.onOverrun(taskOverrun);
   
   particle.advertise(NODE_PARTICLE).setName("Particle").setDatatype(NUMBER_TYPE).setUnit("micro gram per quibik");
+  particle.advertise(NODE_PARTICLE_RAW).setName("Latest sample").setDatatype(NUMBER_TYPE).setUnit("micro gram per quibik");
+  particle.advertise(NODE_PARTICLE_SAMPLES).setName("Samples since last update").setDatatype("integer");
+  particle.advertise(NODE_PARTICLE_PM1).setName("PM1.0").setDatatype(NUMBER_TYPE).setUnit("micro gram per quibik");
+  particle.advertise(NODE_PARTICLE_PM10).setName("PM10").setDatatype(NUMBER_TYPE).setUnit("micro gram per quibik");
+  particle.advertise(NODE_PARTICLE_STATUS).setName("Status bytes (hex)").setDatatype("string");
+  particle.advertise(NODE_PARTICLE_GOODFRAMES).setName("Frames with valid checksum").setDatatype("integer");
+  particle.advertise(NODE_PARTICLE_BADFRAMES).setName("Frames with invalid checksum").setDatatype("integer");
+  particle.advertise(NODE_PARTICLE_RESYNCS).setName("Searched frame starts").setDatatype("integer");
+  particle.advertise(NODE_PARTICLE_OVERFLOWS).setName("Overflows of the receive buffer").setDatatype("integer");
+  particle.advertise(NODE_PARTICLE_REJECTED).setName("Samples rejected by the filter").setDatatype("integer");
   temperaturNode.advertise(NODE_TEMPERATUR).setName("Degrees")
                                       .setDatatype("float")
                                       .setUnit("ºC");
@@ -467,10 +1370,21 @@ void setup()
   altitudeNode.advertise(NODE_ALTITUDE).setName("Altitude")
                                       .setDatatype("float")
                                       .setUnit("m");
+  temperaturNode.advertise(NODE_BMX_LATENCY).setName("Measurement later than the publish")
+                                      .setDatatype("integer")
+                                      .setUnit("ms");
+  temperaturNode.advertise(NODE_BMX_DURATION).setName("Measurement duration")
+                                      .setDatatype("integer")
+                                      .setUnit("ms");
 #ifdef BME680
   gasNode.advertise(NODE_GAS).setName("Gas")
                               .setDatatype("float")
                               .setUnit(" KOhms");
+  gasNode.advertise(NODE_GAS_IAQ).setName("Air quality index (0 excellent, 500 worst)")
+                              .setDatatype("integer");
+  gasNode.advertise(NODE_GAS_BASELINE).setName("Gas in clean air")
+                              .setDatatype("float")
+                              .setUnit(" KOhms");
   humidityNode.advertise(NODE_HUMIDITY).setName("Humidity")
                               .setDatatype("float")
                               .setUnit("%");
@@ -478,20 +1392,26 @@ void setup()
   ledStripNode.advertise(NODE_AMBIENT).setName("All Leds")
                             .setDatatype("color").setFormat("rgb")
                             .settable(ledHandler);
+  publishNode.advertise(NODE_PUBLISH_SENT).setName("Published values").setDatatype("integer");
+  publishNode.advertise(NODE_PUBLISH_SUPPRESSED).setName("Unchanged values, not published").setDatatype("integer");
+  publishNode.advertise(NODE_PUBLISH_OVERRUNS).setName("Tasks, which needed longer than their budget").setDatatype("integer");
+  publishNode.advertise(NODE_PUBLISH_LOGDROPPED).setName("Log messages, dropped as the queue was full").setDatatype("integer");
+  publishNode.advertise(NODE_PUBLISH_LOGSUPPRESSED).setName("Repeated log messages, not published").setDatatype("integer");
+  publishNode.advertise(NODE_PUBLISH_LOGBATCHES).setName("Published arrays of log messages").setDatatype("integer");
   buttonNode.advertise(NODE_BUTTON).setName("Button pressed")
                             .setDatatype("integer");
 #if VICTRON
-  mpptNode.advertise(NODE_MPPT).setName("MPPT")
-                              .setDatatype("json");
-  solarNode.advertise(NODE_SOLAR).setName("Solar")
-                            .setDatatype("integer");
-
-  solarNode.advertise(NODE_SOLAR_BATTERYVOLT).setName("Solar")
-                            .setDatatype("integer").setUnit("mV");
-  solarNode.advertise(NODE_SOLAR_PANELPOWER).setName("Panel")
+  for (uint8_t i = 0; i < VICTRON_COUNT; i++) {
+    mpptAdvertise(i);
+  }
+#if VICTRON_COUNT > 1
+  solarTotalNode.advertise(NODE_SOLAR_PANELPOWER).setName("Panel")
                             .setDatatype("integer").setUnit("W");
-  solarNode.advertise(NODE_SOLAR_PANELVOLT).setName("Panel")
-                            .setDatatype("integer").setUnit("mV");
+  solarTotalNode.advertise(NODE_SOLAR_YIELD_TODAY).setName("Yield today")
+                            .setDatatype("integer").setUnit("Wh");
+  solarTotalNode.advertise(NODE_SOLAR_YIELD_TOTAL).setName("Yield total")
+                            .setDatatype("integer").setUnit("Wh");
+#endif
 #endif
   strip.begin();
 
@@ -501,36 +1421,25 @@ void setup()
   {
     if (i2cEnable.get()) {
 #ifdef BME680
-    printf("Wait 1 second...\r\n");
+    SERIAL_DEBUG("Wait 1 second...\r\n");
     delay(1000);
 #endif
       /* activate I2C for BOSCH sensor */
       Wire.begin(SENSOR_I2C_SDI, SENSOR_I2C_SCK);
-      printf("Wait 50 milliseconds...\r\n");
+      SERIAL_DEBUG("Wait 50 milliseconds...\r\n");
       delay(50);
       /* Extracted from library's example */
       mFailedI2Cinitialization = !bmx.begin();
       if (!mFailedI2Cinitialization) {
         strip.fill(strip.Color(0,PERCENT2FACTOR(64, rgbDim),0));
         strip.show();
+        bmpConfigure();
 #ifdef BME680
-        bmx.setTemperatureOversampling(BME680_OS_8X);
-        bmx.setHumidityOversampling(BME680_OS_2X);
-        bmx.setPressureOversampling(BME680_OS_4X);
-        bmx.setIIRFilterSize(BME680_FILTER_SIZE_3);
-        bmx.setGasHeater(320, 150); // 320*C for 150 ms
+        mIaq.begin();
 #endif
-#ifdef BMP280
-      /* Default settings from datasheet. */
-      bmx.setSampling(Adafruit_BMP280::MODE_NORMAL,     /* Operating Mode. */
-                      Adafruit_BMP280::SAMPLING_X2,     /* Temp. oversampling */
-                      Adafruit_BMP280::SAMPLING_X16,    /* Pressure oversampling */
-                      Adafruit_BMP280::FILTER_X16,      /* Filtering. */
-                      Adafruit_BMP280::STANDBY_MS_500); /* Standby time. */
-#endif
-        printf("Sensor found on I2C bus\r\n");
+        SERIAL_DEBUG("Sensor found on I2C bus\r\n");
       } else {
-        printf("Failed to initialize I2C bus\r\n");
+        SERIAL_DEBUG("Failed to initialize I2C bus\r\n");
       }
     }
     /* Nothing when sleeping */
@@ -554,6 +1463,7 @@ void setup()
 void loop()
 {
   Homie.loop();
+  logLoop();
   /* use the pin, receiving the soft serial additionally as button */
   if (digitalRead(GPIO_BUTTON) == LOW) {
     if ((millis() - mLastButtonAction) > BUTTON_CHECK_INTERVALL) {
@@ -561,7 +1471,9 @@ void loop()
     }
     if (mButtonPressed > BUTTON_MIN_ACTION_CYCLE) {
       digitalWrite(WITTY_RGB_R, HIGH);
-      digitalWrite(WITTY_RGB_B, LOW);
+      if (mBlueLed) {
+        digitalWrite(WITTY_RGB_B, LOW);
+      }
       strip.fill(strip.Color(0,0,0));
       strip.setPixelColor(0, strip.Color((mButtonPressed % 100),0,0));
       strip.setPixelColor(1, strip.Color((mButtonPressed / 100),0,0));
@@ -577,20 +1489,33 @@ void loop()
     if (SPIFFS.exists("/homie/config.json")) {
       strip.fill(strip.Color(0,PERCENT2FACTOR(127, rgbDim),0));
       strip.show();
-      printf("Resetting config\r\n");
+      SERIAL_DEBUG("Resetting config\r\n");
       SPIFFS.remove("/homie/config.json");
       SPIFFS.end();
       delay(50);
       Homie.reboot();
     } else {
-      printf("No config present\r\n");
+      SERIAL_DEBUG("No config present\r\n");
       strip.fill(strip.Color(0,0,128));
       strip.show();
     }
   }
 
+  /* Collect the bytes of the particle sensor, without waiting for them */
+  pm1006.loop();
+  if (pmSerial.overflow()) {
+    mParticleOverflows++;
+  }
+  if (pm1006.hasFrame()) {
+    pmFilter.add(pm1006.getFrame().getPM25());
+    pm1006.release();
+  }
+
 #ifdef VICTRON
-  // Read victron MPPT
-  mppt.loop();
+  // Read victron MPPT, each charger parses a limited amount of bytes, the first one changes every loop
+  for (uint8_t i = 0; i < VICTRON_COUNT; i++) {
+    mppt[(mMpptFirst + i) % VICTRON_COUNT]->loop();
+  }
+  mMpptFirst = (mMpptFirst + 1) % VICTRON_COUNT;
 #endif
 }
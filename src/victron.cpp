@@ -12,98 +12,230 @@
 #include "victron.h"
 #include "MqttLog.h"
 #include "VictronTexts.h"
+#include "JsonWriter.h"
+
+/* the debug block is sent at VICTRON_DEBUG_BATCH bytes, the last line may exceed it */
+static_assert((VICTRON_DEBUG_BATCH + VICTRON_LINE_MAX) <= MQTT_LOG_MESSAGE_MAX, "a debug block must fit into one log message");
 
 namespace victron {
 
     static const char *const TAG = "victron";
 
+    /* label, stored field, interpretation of the value */
+#define VICTRON_LABELS(X) \
+    X("V",      FIELD_BATTERY_VOLTAGE,      PARSE_INT)      /* mV */ \
+    X("VPV",    FIELD_PANEL_VOLTAGE,        PARSE_INT)      /* mV */ \
+    X("PPV",    FIELD_PANEL_POWER,          PARSE_INT)      /* W */ \
+    X("I",      FIELD_BATTERY_CURRENT,      PARSE_INT)      /* mA */ \
+    X("IL",     FIELD_LOAD_CURRENT,         PARSE_INT)      /* mA */ \
+    X("LOAD",   FIELD_LOAD_STATE,           PARSE_ONOFF) \
+    X("H19",    FIELD_YIELD_TOTAL,          PARSE_YIELD) \
+    X("H20",    FIELD_YIELD_TODAY,          PARSE_YIELD) \
+    X("H21",    FIELD_MAX_POWER_TODAY,      PARSE_INT)      /* W */ \
+    X("H22",    FIELD_YIELD_YESTERDAY,      PARSE_YIELD) \
+    X("H23",    FIELD_MAX_POWER_YESTERDAY,  PARSE_INT)      /* W */ \
+    X("ERR",    FIELD_ERROR_CODE,           PARSE_INT) \
+    X("CS",     FIELD_CHARGING_MODE,        PARSE_INT) \
+    X("PID",    FIELD_DEVICE_TYPE,          PARSE_HEX) \
+    X("HSDS",   FIELD_DAY_NUMBER,           PARSE_INT) \
+    X("MPPT",   FIELD_TRACKING_MODE,        PARSE_INT) \
+    X("Alarm",  FIELD_SKIP,                 PARSE_SKIP) \
+    X("Relay",  FIELD_SKIP,                 PARSE_SKIP) \
+    X("OR",     FIELD_SKIP,                 PARSE_SKIP) \
+    X("FW",     FIELD_SKIP,                 PARSE_SKIP) \
+    X("FWE",    FIELD_SKIP,                 PARSE_SKIP) \
+    X("SER#",   FIELD_SKIP,                 PARSE_SKIP)
+
+    /**
+     * @brief Find the table entry of a label by its hash
+     * The switch is resolved at compile time, a collision of two known labels stops the build.
+     * @return false for unknown labels
+     */
+    bool find_label(uint32_t hash, const char *label, VictronLabel &entry)
+    {
+        switch (hash) {
+#define VICTRON_LABEL_CASE(l, f, p) case label_hash(l): entry.label = l; entry.field = f; entry.parse = p; break;
+        VICTRON_LABELS(VICTRON_LABEL_CASE)
+#undef VICTRON_LABEL_CASE
+        default:
+            return false;
+        }
+        /* an unknown label may share the hash */
+        return (strcmp(entry.label, label) == 0);
+    }
+
     VictronComponent::~VictronComponent()
     {
 
     }
 
-    VictronComponent::VictronComponent(int initialstate)
+    VictronComponent::VictronComponent(int initialstate) : VictronComponent(Serial, initialstate)
+    {
+
+    }
+
+    VictronComponent::VictronComponent(Stream &source, int initialstate) : source_(source), hex_(source)
     {
         this->state_ = initialstate;
     }
 
     void VictronComponent::activateDebugging(debug_serialcommunication debugFunction)
     {
+        if (!debugFunction) {
+            /* nothing collected is lost */
+            debug_flush_();
+        }
         this->fdebugSerial = debugFunction;
+        complete_line_length_ = 0;
+    }
+
+    void VictronComponent::debug_line_(uint32_t now)
+    {
+        if (complete_line_length_ == 0) {
+            return;
+        }
+        /* the line and its separator must fit, otherwise it is dropped */
+        if ((size_t) (debug_length_ + complete_line_length_ + 1) < sizeof(debug_batch_)) {
+            if (debug_length_ == 0) {
+                debug_first_ = now;
+            }
+            memcpy(debug_batch_ + debug_length_, complete_line_, complete_line_length_);
+            debug_length_ += complete_line_length_;
+            debug_batch_[debug_length_++] = '\n';
+            debug_batch_[debug_length_] = '\0';
+            debug_lines_++;
+        } else {
+            debug_dropped_++;
+        }
+        complete_line_length_ = 0;
+
+        if (debug_length_ >= VICTRON_DEBUG_BATCH) {
+            debug_flush_();
+        }
+    }
+
+    void VictronComponent::debug_flush_()
+    {
+        if ((debug_length_ > 0) && fdebugSerial) {
+            /* remove the last separator */
+            debug_batch_[debug_length_ - 1] = '\0';
+            if (!fdebugSerial(debug_batch_)) {
+                debug_dropped_ += debug_lines_;
+            }
+        }
+        debug_length_ = 0;
+        debug_lines_ = 0;
     }
 
     void VictronComponent::logTextSensor(String tag, String message, std::string text)
     {
-        String complete = message + " : " +  String(text.c_str());
-        log(MQTT_LEVEL_INFO, complete, MQTT_LOG_VICTRON);
+        LOG(MQTT_LEVEL_INFO, message + " : " +  String(text.c_str()), MQTT_LOG_VICTRON);
     }
 
     void VictronComponent::logBinarySensor(String tag, String message, bool flag)
     {
-        String complete = message + " : " +  String(flag);
-        log(MQTT_LEVEL_INFO, complete, MQTT_LOG_VICTRON);
+        LOG(MQTT_LEVEL_INFO, message + " : " +  String(flag), MQTT_LOG_VICTRON);
     }
 
     void VictronComponent::logSensor(String tag, String message, int number)
     {
-        String complete = message + " : " +  String(number);
-        log(MQTT_LEVEL_INFO, complete, MQTT_LOG_VICTRON);
+        LOG(MQTT_LEVEL_INFO, message + " : " +  String(number), MQTT_LOG_VICTRON);
+    }
+
+    void VictronComponent::append_(char *buffer, uint8_t &length, uint8_t maximum, uint8_t c)
+    {
+        if (length < maximum) {
+            buffer[length++] = c;
+            buffer[length] = '\0';
+        } else {
+            overlong_ = true;
+        }
     }
 
     void VictronComponent::loop()
     {
         const uint32_t now = millis();
-        if ((state_ > 0) && (now - last_transmission_ >= 200)) {
+        /* send queued HEX requests and retry the missing answers */
+        hex_.loop(now);
+
+        if (((state_ > 0) || frame_started_) && (now - last_transmission_ >= 200)) {
             // last transmission too long ago. Reset RX index.
-            log(MQTT_LEVEL_INFO, "Last transmission too long ago", MQTT_LOG_VICTRON);
+            LOG(MQTT_LEVEL_INFO, F("Last transmission too long ago"), MQTT_LOG_VICTRON);
             state_ = 0;
+            if (frame_started_) {
+                truncated_frames_++;
+                discard_frame_();
+            }
+        }
+
+        /* send collected lines at least every VICTRON_DEBUG_INTERVAL */
+        if ((debug_length_ > 0) && (now - debug_first_ >= VICTRON_DEBUG_INTERVAL)) {
+            debug_flush_();
         }
 
-        if (!Serial.available())
+        if (!source_.available())
             return;
 
         last_transmission_ = now;
-        while (Serial.available()) {
+        /* Limit the work per call, the rest is parsed with the next call */
+        for (int budget = VICTRON_BYTES_PER_LOOP; (budget > 0) && source_.available(); budget--) {
             uint8_t c;
-            c = Serial.read();
+            c = source_.read();
+            bytes_received_++;
+            /* a HEX frame between two text frames does not start a new text frame */
+            const bool text_started = frame_started_;
+
+            /* All bytes of the text protocol are part of the checksum, ve.direct hex frames are not */
+            if (state_ != 3) {
+                checksum_ += c;
+                frame_started_ = true;
+            }
 
             if (fdebugSerial) /* debugging enabled */
             {
-                /* always store the incoming data */
-                complete_line_.push_back(c);
+                /* always store the incoming data, cut too long lines */
+                if (c == '\r' || c == '\n') {
+                    debug_line_(now);
+                } else if (complete_line_length_ < VICTRON_LINE_MAX) {
+                    complete_line_[complete_line_length_++] = c;
+                }
             }
 
             if (state_ == 0) {
             if (c == '\r' || c == '\n') {
-                if ( (fdebugSerial) /* debugging enabled */ && (complete_line_.length() > 0) )
-                {
-                    fdebugSerial(complete_line_);
-                    complete_line_.clear();
-                }
                 continue;
             }
-            label_.clear();
-            value_.clear();
+            label_length_ = 0;
+            label_[0] = '\0';
+            label_hash_ = label_hash("");
+            hex_length_ = 0;
+            value_length_ = 0;
+            value_[0] = '\0';
+            overlong_ = false;
             state_ = 1;
             }
             if (state_ == 1) {
             // Start of a ve.direct hex frame
             if (c == ':') {
+                checksum_ -= c;
+                frame_started_ = text_started;
                 state_ = 3;
                 continue;
             }
             if (c == '\t') {
                 state_ = 2;
             } else {
-                label_.push_back(c);
+                append_(label_, label_length_, VICTRON_LABEL_MAX, c);
+                label_hash_ = label_hash_step(label_hash_, c);
             }
             continue;
             }
             if (state_ == 2)
             {
-              if (label_ == "Checksum") {
+              if (strcmp(label_, "Checksum") == 0) {
                 state_ = 0;
-                // The checksum is used as end of frame indicator
+                // The checksum byte ends the frame, the values are only used, if the sum is valid
+                end_frame_(now);
                 if ((now - this->last_publish_) >= VICTRON_THROTTLE) {
                 this->last_publish_ = now;
                 this->publishing_ = true;
@@ -113,175 +245,239 @@ namespace victron {
                 continue;
               }
               if (c == '\r' || c == '\n') {
-                if (this->publishing_) {
-                handle_value_();
+                if (overlong_) {
+                    /* Never interpret a cut label or value */
+                    overlong_fields_++;
+                    frame_overlong_ = true;
+                } else if (this->publishing_) {
+                    handle_value_();
                 }
                 state_ = 0;
               } else {
-                value_.push_back(c);
+                append_(value_, value_length_, VICTRON_VALUE_MAX, c);
               }
             }
-            // Discard ve.direct hex frame
+            // Collect ve.direct hex frame, it is handled at the end of the line
             if (state_ == 3) {
             if (c == '\r' || c == '\n') {
+                if (!overlong_) {
+                    handle_hex_();
+                }
                 state_ = 0;
+            } else {
+                append_(hex_frame_, hex_length_, VICTRON_HEX_FRAME_MAX, c);
             }
             }
         }
     }
 
-    void VictronComponent::handle_value_()
+    void VictronComponent::end_frame_(uint32_t now)
     {
-        int value;
-
-        if (label_ == "V") {
-            battery_voltage_sensor_ = atoi(value_.c_str()); /* mV */
-            return;
-        }
-
-        if (label_ == "VPV") {
-            // mV to V
-            panel_voltage_sensor_ = atoi(value_.c_str()); /* mV */
-            return;
-        }
-
-        if (label_ == "PPV") {
-            panel_power_sensor_ = atoi(value_.c_str());
-            return;
+        if (frame_overlong_) {
+            truncated_frames_++;
+            discard_frame_();
+        } else if (checksum_ == 0) {
+            good_frames_++;
+            /* publish all values of the frame at once */
+            data_ = staging_;
+            if (this->publishing_) {
+                aggregate_(now);
+            }
+            frame_fields_ = 0;
+            checksum_ = 0;
+            frame_started_ = false;
+        } else {
+            bad_frames_++;
+            discard_frame_();
         }
+    }
 
-        if (label_ == "I") {
-            // mA to A
-            battery_current_sensor_ = atoi(value_.c_str()); /* mA */
-            return;
-        }
+    void VictronComponent::aggregate_(uint32_t now)
+    {
+        const uint32_t battery = (1UL << FIELD_BATTERY_VOLTAGE) | (1UL << FIELD_BATTERY_CURRENT);
+        uint32_t duration = now - last_sample_;
 
-        if (label_ == "IL") {
-            load_current_sensor_ = atoi(value_.c_str()); /* mA */
-            return;
+        /* integrate only up to the next frame, gaps are not extrapolated */
+        if ((last_sample_ == 0) || (duration > VICTRON_SAMPLE_GAP)) {
+            duration = 0;
         }
+        last_sample_ = now;
 
-        if (label_ == "LOAD") {
-            load_state_binary_sensor_= (value_ == "ON" || value_ == "On");
-            return;
+        if (frame_fields_ & (1UL << FIELD_BATTERY_VOLTAGE)) {
+            window_.battery_voltage.add(data_.battery_voltage_sensor_);
         }
-
-        if (label_ == "Alarm") {
-            /* Skip Alarm */
-            return;
+        if (frame_fields_ & (1UL << FIELD_BATTERY_CURRENT)) {
+            window_.battery_current.add(data_.battery_current_sensor_);
         }
-
-        if (label_ == "H19") {
-            yield_total_sensor_ =  (atoi(value_.c_str()) * 10.0f);  // NOLINT(cert-err34-c)
-            return;
+        if (frame_fields_ & (1UL << FIELD_PANEL_POWER)) {
+            window_.panel_power.add(data_.panel_power_sensor_);
         }
-
-        if (label_ == "H20") {
-            yield_today_sensor_ = (atoi(value_.c_str()) * 10.0f);  // NOLINT(cert-err34-c)
-            return;
+        if ((frame_fields_ & battery) == battery) {
+            window_.battery_energy += ((int64_t) data_.battery_voltage_sensor_) * data_.battery_current_sensor_ * duration;
         }
-
-        if (label_ == "H21") {
-            max_power_today_sensor_ = (atoi(value_.c_str()));  // NOLINT(cert-err34-c)
-            return;
+        if (frame_fields_ & (1UL << FIELD_PANEL_POWER)) {
+            window_.panel_energy += ((int64_t) data_.panel_power_sensor_) * duration;
         }
+        window_.frames++;
+    }
 
-        if (label_ == "H22") {
-            yield_yesterday_sensor_ = (atoi(value_.c_str()) * 10.0f);  // NOLINT(cert-err34-c)
-            return;
-        }
+    void VictronComponent::discard_frame_()
+    {
+        staging_ = data_;
+        frame_fields_ = 0;
+        checksum_ = 0;
+        frame_started_ = false;
+        frame_overlong_ = false;
+    }
 
-        if (label_ == "H23") {
-            max_power_yesterday_sensor_ = atoi(value_.c_str());
-            return;
-        }
+    void VictronComponent::handle_hex_()
+    {
+        VictronHexResponse response;
 
-        if (label_ == "ERR") {
-            value = atoi(value_.c_str());  // NOLINT(cert-err34-c)
-            error_code_sensor_ =  value;
+        if (!hex_.receive(hex_frame_, hex_length_, response) || (response.flags != 0)) {
             return;
         }
-
-        if (label_ == "CS") {
-            value = atoi(value_.c_str());  // NOLINT(cert-err34-c)
-            charging_mode_id_sensor_ = value;
-            return;
+        switch (response.reg) {
+            case VICTRON_REG_LOAD_OUTPUT_CONTROL:
+            load_output_control_ = response.value;
+            break;
+            default:
+            break;
         }
+    }
 
+    void VictronComponent::handle_value_()
+    {
+        VictronLabel entry;
+        long value;
 
-        if (label_ == "FW") {
-            /* Skip firmware */
+        if (!find_label(label_hash_, label_, entry)) {
+            unknown_labels_++;
+            LOG(MQTT_LEVEL_ERROR, String("Unhandled property:") + label_ + " : " + value_, MQTT_LOG_VICTRON);
             return;
         }
 
-
-        if (label_ == "PID") {
-            device_type_text_sensor_ = strtol(value_.c_str(), nullptr, 0);
+        switch (entry.parse) {
+            case PARSE_INT:
+            value = atol(value_);  // NOLINT(cert-err34-c)
+            break;
+            case PARSE_YIELD:
+            value = atol(value_) * 10;  // NOLINT(cert-err34-c)
+            break;
+            case PARSE_HEX:
+            value = strtol(value_, nullptr, 0);
+            break;
+            case PARSE_ONOFF:
+            value = (strcmp(value_, "ON") == 0 || strcmp(value_, "On") == 0);
+            break;
+            default:
             return;
         }
+        store_(entry.field, value);
+    }
 
-        if (label_ == "HSDS") {
-            day_number_sensor_ = atoi(value_.c_str());
-            return;
-        }
-        
-        if (label_ == "MPPT") {
-            value = atoi(value_.c_str());  // NOLINT(cert-err34-c)
-            tracking_mode_id_sensor_ = value;
-            return;
+    void VictronComponent::store_(uint8_t field, long value)
+    {
+        frame_fields_ |= (1UL << field);
+        switch (field) {
+            case FIELD_BATTERY_VOLTAGE:
+            staging_.battery_voltage_sensor_ = value;
+            break;
+            case FIELD_PANEL_VOLTAGE:
+            staging_.panel_voltage_sensor_ = value;
+            break;
+            case FIELD_PANEL_POWER:
+            staging_.panel_power_sensor_ = value;
+            break;
+            case FIELD_BATTERY_CURRENT:
+            staging_.battery_current_sensor_ = value;
+            break;
+            case FIELD_LOAD_CURRENT:
+            staging_.load_current_sensor_ = value;
+            break;
+            case FIELD_LOAD_STATE:
+            staging_.load_state_binary_sensor_ = (value != 0);
+            break;
+            case FIELD_YIELD_TOTAL:
+            staging_.yield_total_sensor_ = value;
+            break;
+            case FIELD_YIELD_TODAY:
+            staging_.yield_today_sensor_ = value;
+            break;
+            case FIELD_MAX_POWER_TODAY:
+            staging_.max_power_today_sensor_ = value;
+            break;
+            case FIELD_YIELD_YESTERDAY:
+            staging_.yield_yesterday_sensor_ = value;
+            break;
+            case FIELD_MAX_POWER_YESTERDAY:
+            staging_.max_power_yesterday_sensor_ = value;
+            break;
+            case FIELD_ERROR_CODE:
+            staging_.error_code_sensor_ = value;
+            break;
+            case FIELD_CHARGING_MODE:
+            staging_.charging_mode_id_sensor_ = value;
+            break;
+            case FIELD_DEVICE_TYPE:
+            staging_.device_type_text_sensor_ = value;
+            break;
+            case FIELD_DAY_NUMBER:
+            staging_.day_number_sensor_ = value;
+            break;
+            case FIELD_TRACKING_MODE:
+            staging_.tracking_mode_id_sensor_ = value;
+            break;
+            default:
+            break;
         }
-
-        String message= "Unhandled property:" + String(label_.c_str()) + " : " +  String(value_.c_str());
-        log(MQTT_LEVEL_ERROR, message, MQTT_LOG_VICTRON);
     }
 
-    String VictronComponent::toJson(void)
+    size_t VictronComponent::toJson(char *buffer, size_t size)
     {
-        String buffer;
+        JsonWriter json(buffer, size);
+        json.beginObject();
         if (this->last_publish_ <= 0)
         {
-            buffer += "{ ";
-            buffer += "\"mode\": \"nodata\",\n";
-            buffer += "\"state\":" + String(state_) + ",\n";
-            buffer += "\"transmission\":" + String(last_transmission_) + ",\n";
-            buffer += "\"publish\":" + String(last_publish_) + "\n";
-            buffer += "}";
-            return buffer;
+            json.add("mode", "nodata");
+            json.add("state", (long) state_);
+            json.add("transmission", (long) last_transmission_);
+            json.add("publish", (long) last_publish_);
         }
         else
         {
-            buffer += "{ ";
-            buffer += "\"mode\": \"newdata\",\n";
-            buffer += "\"load\":" + String(load_state_binary_sensor_) + ",\n";
-            buffer += "\"MaxPower\":{\n";
-            buffer += "\"yesterday\":" + String(max_power_yesterday_sensor_) + ",\n";
-            buffer += "\"today\":" + String(max_power_today_sensor_) + "\n";
-            buffer += "},\n";
-            buffer += "\"Yield\":{\n";
-            buffer += "\"Total\":" + String(yield_total_sensor_) + ",\n";
-            buffer += "\"Yesterday\":" + String(yield_yesterday_sensor_) + ",\n";
-            buffer += "\"Today\":" + String(yield_today_sensor_) + "\n";
-            buffer += "},\n";
-            buffer += "\"Panel\":{\n";
-            buffer += "\"Voltage\":" + String(panel_voltage_sensor_) + ",\n";
-            buffer += "\"Power\":" + String(panel_power_sensor_) + "\n";
-            buffer += "},\n";
-            buffer += "\"Bat\":{\n";
-            buffer += "\"Voltage\":" + String(battery_voltage_sensor_) + ",\n";
-            buffer += "\"Current\":" + String(battery_current_sensor_) + "\n";
-            buffer += "},\n";
-            buffer += "\"LoadCurrent\":" + String(load_current_sensor_) + ",\n";
-            buffer += "\"DayNumber\":" + String(day_number_sensor_) + ",\n";
-            buffer += "\"ChargingModeID\":" + String(charging_mode_id_sensor_) + ",\n";
-            buffer += "\"ErrorCode\":" + String(error_code_sensor_) + ",\n";
-            buffer += "\"TrackingModeID\":" + String(tracking_mode_id_sensor_) + ",\n";
-            buffer += "\"ErrorText\": \"" + String(error_code_text(error_code_sensor_).c_str()) + "\",\n";
-            buffer += "\"TrackingMode\": \"" + String(tracking_mode_text(tracking_mode_id_sensor_).c_str()) + "\",\n";
-            buffer += "\"ChargingMode\": \"" + String(charging_mode_text(charging_mode_id_sensor_).c_str()) + "\",\n";
-            buffer += "\"DeviceType\": \"" + String(device_type_text(device_type_text_sensor_).c_str() ) + "\",\n";
-            buffer += "}";
-            return buffer;
+            json.add("mode", "newdata");
+            json.add("load", (long) data_.load_state_binary_sensor_);
+            json.beginObject("MaxPower");
+            json.add("yesterday", (long) data_.max_power_yesterday_sensor_);
+            json.add("today", (long) data_.max_power_today_sensor_);
+            json.endObject();
+            json.beginObject("Yield");
+            json.addFixed("Total", data_.yield_total_sensor_ * 100, 2);
+            json.addFixed("Yesterday", data_.yield_yesterday_sensor_ * 100, 2);
+            json.addFixed("Today", data_.yield_today_sensor_ * 100, 2);
+            json.endObject();
+            json.beginObject("Panel");
+            json.add("Voltage", (long) data_.panel_voltage_sensor_);
+            json.add("Power", (long) data_.panel_power_sensor_);
+            json.endObject();
+            json.beginObject("Bat");
+            json.add("Voltage", (long) data_.battery_voltage_sensor_);
+            json.add("Current", (long) data_.battery_current_sensor_);
+            json.endObject();
+            json.add("LoadCurrent", (long) data_.load_current_sensor_);
+            json.add("DayNumber", (long) data_.day_number_sensor_);
+            json.add("ChargingModeID", (long) data_.charging_mode_id_sensor_);
+            json.add("ErrorCode", (long) data_.error_code_sensor_);
+            json.add("TrackingModeID", (long) data_.tracking_mode_id_sensor_);
+            json.add("LoadControl", (long) load_output_control_);
+            json.addP("ErrorText", error_code_text(data_.error_code_sensor_));
+            json.addP("TrackingMode", tracking_mode_text(data_.tracking_mode_id_sensor_));
+            json.addP("ChargingMode", charging_mode_text(data_.charging_mode_id_sensor_));
+            json.addP("DeviceType", device_type_text(data_.device_type_text_sensor_));
         }
+        json.endObject();
+        return json.length();
     }
 }
-#endif /* VICTRON */ 
+#endif /* VICTRON */